@@ -0,0 +1,552 @@
+/*
+ * ai.c
+ *
+ * Iterative deepening alpha-beta search for the computer player
+ *
+ * Author: Eve
+ */
+
+#include "ai.h"
+#include "book.h"
+#include "eval.h"
+#include "progmem.h"
+#include "search_memory.h"
+#include "timer0.h"
+
+// the AVR has room for a handful of buckets and a shallow search, the
+// host can afford a table of a few megabytes
+#ifdef __AVR__
+#define TT_BUCKETS 16
+#define MAX_DEPTH 8
+#else
+#define TT_BUCKETS 65536UL
+#define MAX_DEPTH 32
+#endif
+
+#define MAX_PLY (MAX_DEPTH + 1)
+
+// scores beyond this are wins or losses a known number of plies away
+#define WIN_BOUND (WIN_SCORE - MAX_PLY)
+#define INFINITE_SCORE (WIN_SCORE + 1)
+
+// how many nodes ai_choose_move searches between looks at the clock
+#define TIME_CHECK_INTERVAL 256
+
+// what a transposition table score says about the true score
+#define BOUND_NONE 0
+#define BOUND_EXACT 1
+#define BOUND_LOWER 2
+#define BOUND_UPPER 3
+
+// 8 bytes, checked against the top 16 bits of the key
+typedef struct {
+	uint16_t check;
+	int16_t score;
+	uint8_t depth;
+	uint8_t bound;
+	Move move;
+} TTEntry;
+
+// the first entry keeps the deepest search, the second always takes the
+// latest one
+typedef struct {
+	TTEntry entries[2];
+} TTBucket;
+
+static THREAD_LOCAL TTBucket tt[TT_BUCKETS];
+
+// two quiet moves per ply which recently caused a cutoff
+static THREAD_LOCAL Move killers[MAX_PLY][2];
+
+// 1 until the search has gone as deep as it can
+static THREAD_LOCAL uint8_t searching;
+// the ply of the node being searched
+static THREAD_LOCAL uint8_t search_ply;
+// the deepest finished iteration, and its best move and score
+static THREAD_LOCAL uint8_t search_depth;
+static THREAD_LOCAL Move best_move;
+static THREAD_LOCAL int16_t best_score;
+static THREAD_LOCAL uint32_t nodes;
+
+// while the opponent thinks, the search first predicts their move (by
+// searching their position to PONDER_PREDICT_DEPTH, unless the table
+// already has a move for it) and then searches the position it leads to
+#define PONDER_OFF 0
+#define PONDER_PREDICTING 1
+#define PONDER_SEARCHING 2
+#define PONDER_PREDICT_DEPTH 2
+
+static THREAD_LOCAL uint8_t ponder_state = PONDER_OFF;
+// the position the ponder search is searching, to recognise a hit
+static THREAD_LOCAL ZobristKey ponder_key;
+static THREAD_LOCAL uint32_t ponder_pieces[2];
+
+#define NULL_MOVE_SQUARE 0xFF
+
+static uint8_t same_move(Move a, Move b) {
+	return a.from == b.from && a.to == b.to;
+}
+
+static uint16_t key_check(ZobristKey key) {
+	return (uint16_t)(key >> (sizeof(ZobristKey) * 8 - 16));
+}
+
+static TTBucket *tt_bucket(ZobristKey key) {
+	return &tt[(uint32_t)key & (TT_BUCKETS - 1)];
+}
+
+// mate scores are stored relative to the position rather than the root
+static int16_t score_to_tt(int16_t score, uint8_t ply) {
+	if (score > WIN_BOUND) {
+		return score + ply;
+	} else if (score < -WIN_BOUND) {
+		return score - ply;
+	}
+	return score;
+}
+
+static int16_t score_from_tt(int16_t score, uint8_t ply) {
+	if (score > WIN_BOUND) {
+		return score - ply;
+	} else if (score < -WIN_BOUND) {
+		return score + ply;
+	}
+	return score;
+}
+
+static TTEntry *tt_probe(ZobristKey key) {
+	TTBucket *bucket = tt_bucket(key);
+	uint16_t check = key_check(key);
+	for (uint8_t i = 0; i < 2; i++) {
+		TTEntry *entry = &bucket->entries[i];
+		if (entry->bound != BOUND_NONE && entry->check == check) {
+			return entry;
+		}
+	}
+	return 0;
+}
+
+static void tt_store(ZobristKey key, int16_t score, uint8_t depth, uint8_t bound, Move move) {
+	TTBucket *bucket = tt_bucket(key);
+	uint16_t check = key_check(key);
+	TTEntry *entry = &bucket->entries[1];
+	if (bucket->entries[0].check == check || depth >= bucket->entries[0].depth
+			|| bucket->entries[0].bound == BOUND_NONE) {
+		entry = &bucket->entries[0];
+	}
+	entry->check = check;
+	entry->score = score;
+	entry->depth = depth;
+	entry->bound = bound;
+	entry->move = move;
+}
+
+// a rough guess at how good a move is: how far it takes the player
+// along the lines through its destination and how many of the
+// opponent's lines it blocks
+static uint8_t move_order_score(const Position *position, Move move) {
+	uint8_t player = position->player;
+	const uint8_t *own = position->line_counts[player - 1];
+	const uint8_t *other = position->line_counts[OPPONENT(player) - 1];
+	uint8_t score = 0;
+	for (uint8_t n = 0; n < MAX_LINES_PER_SQUARE; n++) {
+		uint8_t line = get_square_line(move.to, n);
+		if (line == NO_LINE) {
+			break;
+		}
+		if (other[line] == 0) {
+			score += own[line] * own[line] * 4;
+		} else if (own[line] == 0) {
+			score += other[line] * other[line];
+		}
+	}
+	return score;
+}
+
+// sorts the moves so the best looking come first: the table move, then
+// the killers, then the rest by move_order_score
+static void order_moves(const Position *position, MoveList *list, Move tt_move, uint8_t ply) {
+	uint8_t scores[MAX_MOVES];
+	for (uint8_t i = 0; i < list->count; i++) {
+		Move move = list->moves[i];
+		if (same_move(move, tt_move)) {
+			scores[i] = 255;
+		} else if (same_move(move, killers[ply][0])) {
+			scores[i] = 254;
+		} else if (same_move(move, killers[ply][1])) {
+			scores[i] = 253;
+		} else {
+			uint8_t score = move_order_score(position, move);
+			scores[i] = score > 252 ? 252 : score;
+		}
+	}
+	// insertion sort, there are never more than MAX_MOVES
+	for (uint8_t i = 1; i < list->count; i++) {
+		Move move = list->moves[i];
+		uint8_t score = scores[i];
+		uint8_t j = i;
+		while (j > 0 && scores[j - 1] < score) {
+			list->moves[j] = list->moves[j - 1];
+			scores[j] = scores[j - 1];
+			j--;
+		}
+		list->moves[j] = move;
+		scores[j] = score;
+	}
+}
+
+static void add_killer(Move move, uint8_t ply) {
+	if (!same_move(move, killers[ply][0])) {
+		killers[ply][1] = killers[ply][0];
+		killers[ply][0] = move;
+	}
+}
+
+// the search keeps its own stack of frames rather than recursing, so it
+// can stop after any node and carry on from there on the next call. On
+// the AVR only the node being searched has its moves listed, so a frame
+// keeps what it takes to list and order its node's moves the same way
+// again when the search comes back up to it: the table move and how far
+// it has got (the killers for its ply don't change until it has had a
+// cutoff). The host can afford a list for every ply instead.
+typedef struct {
+	Move tt_move;
+	// the move being searched
+	Move move;
+	Move best;
+	int16_t alpha;
+	int16_t beta;
+	int16_t original_alpha;
+	int16_t best_score;
+	uint8_t depth;
+	// the number of moves, and the index in the search order of the move
+	// being searched
+	uint8_t count;
+	uint8_t next;
+} SearchFrame;
+
+#ifdef __AVR__
+#define MOVE_LISTS 1
+#else
+#define MOVE_LISTS MAX_PLY
+#endif
+
+#ifdef __AVR__
+// the frames, the move list and the position being searched share SRAM
+// with the Monte Carlo search (see search_memory.h)
+typedef struct {
+	SearchFrame frames[MAX_PLY];
+	MoveList move_lists[MOVE_LISTS];
+	Position position;
+} SearchMemory;
+
+_Static_assert(sizeof(SearchMemory) <= SEARCH_MEMORY_SIZE, "alpha-beta search memory too big");
+
+uint8_t search_memory[SEARCH_MEMORY_SIZE];
+
+#define frames (((SearchMemory *)search_memory)->frames)
+#define move_lists (((SearchMemory *)search_memory)->move_lists)
+#define search_position (((SearchMemory *)search_memory)->position)
+#else
+static THREAD_LOCAL SearchFrame frames[MAX_PLY];
+// the moves of the nodes being searched, in the order they are searched
+static THREAD_LOCAL MoveList move_lists[MOVE_LISTS];
+// copy of the position being searched, moves are made and unmade on it
+static THREAD_LOCAL Position search_position;
+#endif
+
+static MoveList *node_moves(uint8_t ply) {
+	return &move_lists[ply % MOVE_LISTS];
+}
+
+// lists the moves of the node at ply, for search_position at that node
+static void list_node_moves(uint8_t ply) {
+	generate_moves(&search_position, node_moves(ply));
+	order_moves(&search_position, node_moves(ply), frames[ply].tt_move, ply);
+}
+
+// sets up the frame for a node at ply in search_position. Returns 1 with
+// the node's score if it can be scored without searching its moves, or
+// 0 if its moves have to be searched.
+static uint8_t enter_node(uint8_t ply, uint8_t depth, int16_t alpha, int16_t beta, int16_t *score) {
+	Position *position = &search_position;
+	SearchFrame *frame = &frames[ply];
+	Move tt_move = {NULL_MOVE_SQUARE, NULL_MOVE_SQUARE};
+
+	nodes++;
+	// the player who just moved has completed a line, or boxed in every
+	// piece of the player to move. Four pieces can't box in four, so the
+	// second never happens in a real game, but a player who can't move
+	// has lost (see position_is_lost).
+	if (position_is_lost(position)) {
+		*score = -(WIN_SCORE - ply);
+		return 1;
+	}
+	// the threat masks settle positions a move or two from the end
+	// without searching them, even at the leaves
+	if (ply > 0 && ply < MAX_PLY - 2) {
+		uint8_t player = position->player;
+		uint32_t threats = winning_squares(position, OPPONENT(player));
+		if (winning_squares(position, player)) {
+			*score = WIN_SCORE - (ply + 1);
+			return 1;
+		}
+		// only one of two winning squares can be blocked
+		if (threats & (threats - 1)) {
+			*score = -(WIN_SCORE - (ply + 2));
+			return 1;
+		}
+	}
+	if (depth == 0 || ply >= MAX_PLY - 1) {
+		*score = evaluate(position);
+		return 1;
+	}
+
+	TTEntry *entry = tt_probe(position->key);
+	if (entry) {
+		tt_move = entry->move;
+		if (ply > 0 && entry->depth >= depth) {
+			int16_t tt_score = score_from_tt(entry->score, ply);
+			if (entry->bound == BOUND_EXACT
+					|| (entry->bound == BOUND_LOWER && tt_score >= beta)
+					|| (entry->bound == BOUND_UPPER && tt_score <= alpha)) {
+				*score = tt_score;
+				return 1;
+			}
+		}
+	}
+
+	frame->tt_move = tt_move;
+	list_node_moves(ply);
+	frame->count = node_moves(ply)->count;
+	frame->best = tt_move;
+	frame->alpha = alpha;
+	frame->beta = beta;
+	frame->original_alpha = alpha;
+	frame->best_score = -INFINITE_SCORE;
+	frame->depth = depth;
+	frame->next = 0;
+	return 0;
+}
+
+// takes the score of the move just searched at ply, moving on to the
+// next move or skipping the rest after a cutoff
+static void move_searched(uint8_t ply, int16_t score) {
+	SearchFrame *frame = &frames[ply];
+	Move move = frame->move;
+	frame->next++;
+	if (score > frame->best_score) {
+		frame->best_score = score;
+		frame->best = move;
+		if (score > frame->alpha) {
+			frame->alpha = score;
+			if (frame->alpha >= frame->beta) {
+				add_killer(move, ply);
+				frame->next = frame->count;
+			}
+		}
+	}
+}
+
+// stores the result of the finished node at ply and returns its score
+static int16_t leave_node(uint8_t ply) {
+	SearchFrame *frame = &frames[ply];
+	uint8_t bound = BOUND_EXACT;
+	if (frame->best_score <= frame->original_alpha) {
+		bound = BOUND_UPPER;
+	} else if (frame->best_score >= frame->beta) {
+		bound = BOUND_LOWER;
+	}
+	tt_store(search_position.key, score_to_tt(frame->best_score, ply),
+			frame->depth, bound, frame->best);
+	return frame->best_score;
+}
+
+// begins the search of the root to the next depth, or ends the search
+// once the maximum depth has been reached
+static void start_iteration(void) {
+	int16_t score;
+	if (search_depth >= MAX_DEPTH
+			|| enter_node(0, search_depth + 1, -INFINITE_SCORE, INFINITE_SCORE, &score)) {
+		searching = 0;
+		return;
+	}
+	search_ply = 0;
+}
+
+void ai_new_game(void) {
+	for (uint32_t i = 0; i < TT_BUCKETS; i++) {
+		tt[i].entries[0].bound = BOUND_NONE;
+		tt[i].entries[1].bound = BOUND_NONE;
+	}
+	for (uint8_t ply = 0; ply < MAX_PLY; ply++) {
+		killers[ply][0].from = NULL_MOVE_SQUARE;
+		killers[ply][0].to = NULL_MOVE_SQUARE;
+		killers[ply][1] = killers[ply][0];
+	}
+}
+
+void ai_search_start(const Position *position) {
+	MoveList list;
+
+	// a search stopped part way down leaves its moves made, and nothing
+	// must try to take them back from the new position (the book and
+	// immediate wins below don't reach start_iteration)
+	search_ply = 0;
+	search_position = *position;
+	search_depth = 0;
+	nodes = 0;
+	searching = 1;
+	ponder_state = PONDER_OFF;
+
+	// fall back on any legal move until a one ply search has finished
+	generate_moves(&search_position, &list);
+	best_move = list.moves[0];
+	best_score = 0;
+
+	// the book's drops and immediate wins are played without searching
+	// at all
+	if (book_lookup(position, &best_move)) {
+		searching = 0;
+		return;
+	}
+	if (find_winning_move(position, &best_move)) {
+		best_score = WIN_SCORE - 1;
+		searching = 0;
+		return;
+	}
+	start_iteration();
+}
+
+uint8_t ai_search_step(uint16_t max_nodes) {
+	uint32_t last_node = nodes + max_nodes;
+	while (searching && nodes < last_node) {
+		SearchFrame *frame = &frames[search_ply];
+		int16_t score;
+		if (frame->next < frame->count) {
+			// go down into the next move
+			frame->move = node_moves(search_ply)->moves[frame->next];
+			make_move(&search_position, frame->move);
+			if (enter_node(search_ply + 1, frame->depth - 1, -frame->beta, -frame->alpha, &score)) {
+				unmake_move(&search_position, frame->move);
+				move_searched(search_ply, -score);
+			} else {
+				search_ply++;
+			}
+		} else {
+			// every move has been searched, go back up
+			score = leave_node(search_ply);
+			if (search_ply == 0) {
+				search_depth = frame->depth;
+				best_move = frame->best;
+				best_score = score;
+				if (score > WIN_BOUND || score < -WIN_BOUND) {
+					// the result is known, searching deeper won't change it
+					searching = 0;
+				} else {
+					start_iteration();
+				}
+			} else {
+				search_ply--;
+				frame = &frames[search_ply];
+				unmake_move(&search_position, frame->move);
+				move_searched(search_ply, -score);
+				// the moves below have overwritten this node's
+				if (MOVE_LISTS == 1 && frame->next < frame->count) {
+					list_node_moves(search_ply);
+				}
+			}
+		}
+	}
+	return searching;
+}
+
+// takes back the moves the search has made, leaving search_position at
+// the root
+static void unwind(void) {
+	while (search_ply > 0) {
+		search_ply--;
+		unmake_move(&search_position, frames[search_ply].move);
+	}
+}
+
+// starts the ponder search of the position after the predicted move,
+// unless that ends the game
+static void ponder_predicted(Move move) {
+	Position position = search_position;
+	make_move(&position, move);
+	if (position_is_lost(&position)) {
+		ponder_state = PONDER_OFF;
+		return;
+	}
+	ai_search_start(&position);
+	ponder_state = PONDER_SEARCHING;
+	ponder_key = position.key;
+	ponder_pieces[0] = position.pieces[0];
+	ponder_pieces[1] = position.pieces[1];
+}
+
+void ai_ponder_start(const Position *position) {
+	TTEntry *entry = tt_probe(position->key);
+	MoveList list;
+
+	ai_search_start(position);
+	ponder_state = PONDER_PREDICTING;
+	// a move from the table saves searching for a prediction, as long as
+	// it is really a legal move here
+	if (entry) {
+		generate_moves(position, &list);
+		for (uint8_t i = 0; i < list.count; i++) {
+			if (same_move(list.moves[i], entry->move)) {
+				ponder_predicted(entry->move);
+				return;
+			}
+		}
+	}
+}
+
+void ai_ponder_step(uint16_t max_nodes) {
+	if (ponder_state == PONDER_PREDICTING) {
+		if (!ai_search_step(max_nodes) || search_depth >= PONDER_PREDICT_DEPTH) {
+			unwind();
+			ponder_predicted(best_move);
+		}
+	} else if (ponder_state == PONDER_SEARCHING) {
+		ai_search_step(max_nodes);
+	}
+}
+
+uint8_t ai_ponder_hit(const Position *position) {
+	uint8_t hit = ponder_state == PONDER_SEARCHING && position->key == ponder_key
+			&& position->pieces[0] == ponder_pieces[0]
+			&& position->pieces[1] == ponder_pieces[1];
+	ponder_state = PONDER_OFF;
+	return hit;
+}
+
+Move ai_best_move(void) {
+	return best_move;
+}
+
+int16_t ai_best_score(void) {
+	return best_score;
+}
+
+uint8_t ai_search_depth(void) {
+	return search_depth;
+}
+
+uint32_t ai_search_nodes(void) {
+	return nodes;
+}
+
+Move ai_choose_move(const Position *position, uint16_t budget) {
+	uint32_t start_time = get_current_time();
+	ai_search_start(position);
+	while (ai_search_step(TIME_CHECK_INTERVAL)) {
+		if (search_depth > 0 && get_current_time() - start_time >= budget) {
+			break;
+		}
+	}
+	return best_move;
+}
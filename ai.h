@@ -0,0 +1,83 @@
+/*
+ * ai.h
+ *
+ * Author: Eve
+ *
+ * A computer player for Teeko. It runs an iterative deepening alpha-beta
+ * search over the position, ordering moves by the transposition table,
+ * killer moves and how much each move does for the lines through the
+ * square it moves to. The transposition table has 64K buckets on the
+ * host but only 16 (256 bytes) on the AVR, where it shares the 2KB of
+ * SRAM with the serial buffers, the game, the other search's state and
+ * the stack. The search's frames share their SRAM with the Monte Carlo
+ * search on the AVR (see search_memory.h).
+ *
+ * The search doesn't recurse, it keeps an explicit stack of frames so
+ * that it can be run a slice of nodes at a time between iterations of
+ * the game loop, with the best move of the deepest finished iteration
+ * always available.
+ */
+
+
+#ifndef AI_H_
+#define AI_H_
+
+#include <stdint.h>
+#include "movegen.h"
+#include "position.h"
+
+// thinking time in milliseconds, short enough that the reply comes
+// within one 500ms cursor flash
+#define AI_TIME_BUDGET 400
+
+// nodes searched per call to ai_search_step from the game loop, a few
+// milliseconds of work on the AVR
+#define AI_SLICE_NODES 32
+
+// score of a won position, less the number of plies to the win
+#define WIN_SCORE 10000
+
+// forgets everything learnt in the previous game
+void ai_new_game(void);
+
+// begins a new search of the position. The position must not have a
+// piece lifted, must not be won and the player to move must have a legal
+// move. If the position is in the opening book, or the player to move
+// can win with their next move, the search finishes straight away with
+// that move (and a depth of 0).
+void ai_search_start(const Position *position);
+
+// searches roughly max_nodes more nodes, then returns 1 if there is more
+// searching to do or 0 once the search has finished (it reached the
+// maximum depth or found a forced result)
+uint8_t ai_search_step(uint16_t max_nodes);
+
+// the best move and its score (for the player to move) from the deepest
+// iteration finished so far. Until the one ply search has finished the
+// move is just the first legal move.
+Move ai_best_move(void);
+int16_t ai_best_score(void);
+
+// the depth of the deepest finished iteration, and the number of nodes
+// searched since ai_search_start
+uint8_t ai_search_depth(void);
+uint32_t ai_search_nodes(void);
+
+// pondering: while the opponent is thinking about their move in
+// position, the search predicts the move they will play and searches the
+// position after it. If they then play that move, ai_ponder_hit returns
+// 1 and the ponder search carries on as the search for the reply (read
+// with ai_search_step and ai_best_move as usual). Otherwise it returns 0
+// and a new search must be started, which still benefits from what the
+// ponder search left in the transposition table.
+void ai_ponder_start(const Position *position);
+void ai_ponder_step(uint16_t max_nodes);
+uint8_t ai_ponder_hit(const Position *position);
+
+// searches the position for at most budget milliseconds (always finishing
+// at least a one ply search) and returns the best move found, with the
+// same requirements as ai_search_start
+Move ai_choose_move(const Position *position, uint16_t budget);
+
+
+#endif /* AI_H_ */
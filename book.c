@@ -0,0 +1,44 @@
+/*
+ * book.c
+ *
+ * Lookup of drop phase positions in the opening book
+ *
+ * Author: Eve
+ */
+
+#include "book.h"
+#include "progmem.h"
+#include "rank.h"
+#include "symmetry.h"
+#include "book_data.h"
+
+uint8_t book_lookup(const Position *position, Move *move) {
+	uint32_t pieces_1 = position->pieces[0];
+	uint32_t pieces_2 = position->pieces[1];
+	uint8_t player = position->player;
+
+	if (position->lifted != NO_SQUARE || position->num_pieces[player - 1] == 4) {
+		return 0;
+	}
+	uint8_t transform = canonicalise_masks(&pieces_1, &pieces_2);
+	uint32_t rank = rank_masks(pieces_1, pieces_2, player);
+
+	// binary search for the first entry not below rank
+	uint16_t low = 0;
+	uint16_t high = BOOK_ENTRIES;
+	while (low < high) {
+		uint16_t middle = (low + high) / 2;
+		if (pgm_read_dword(&book_ranks[middle]) < rank) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	if (low == BOOK_ENTRIES || pgm_read_dword(&book_ranks[low]) != rank) {
+		return 0;
+	}
+	// the entry's square is in the canonical orientation
+	move->from = NO_SQUARE;
+	move->to = transform_square(inverse_transform(transform), pgm_read_byte(&book_squares[low]));
+	return 1;
+}
@@ -0,0 +1,25 @@
+/*
+ * book.h
+ *
+ * Author: Eve
+ *
+ * Opening book for the drop phase, generated on the host from the solved
+ * game by tools/bookgen and kept in flash. Positions are stored in their
+ * canonical orientation, so one entry covers all 8 symmetric positions.
+ */
+
+
+#ifndef BOOK_H_
+#define BOOK_H_
+
+#include <stdint.h>
+#include "movegen.h"
+#include "position.h"
+
+// looks the position up in the book. Returns 1 and sets move to the best
+// drop if it is there, or returns 0 if it isn't (including every phase 2
+// position and any position with a piece lifted).
+uint8_t book_lookup(const Position *position, Move *move);
+
+
+#endif /* BOOK_H_ */
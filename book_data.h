@@ -0,0 +1,317 @@
+/*
+ * book_data.h
+ *
+ * Opening book generated by tools/bookgen from the tablebase, do not
+ * edit. Entries are sorted by the rank of the canonical position (see
+ * canonicalise_masks) and give the square to drop on in that
+ * orientation. Positions with up to 5 pieces on the board are included.
+ */
+
+#ifndef BOOK_DATA_H_
+#define BOOK_DATA_H_
+
+#define BOOK_ENTRIES 1289
+
+static const uint32_t book_ranks[BOOK_ENTRIES] PROGMEM = {
+	0UL, 1UL, 2UL, 3UL, 7UL, 8UL,
+	13UL, 26UL, 27UL, 28UL, 29UL, 31UL,
+	32UL, 33UL, 34UL, 37UL, 38UL, 39UL,
+	43UL, 44UL, 49UL, 636UL, 659UL, 682UL,
+	705UL, 728UL, 774UL, 889UL, 912UL, 935UL,
+	958UL, 981UL, 1004UL, 1027UL, 1050UL, 1073UL,
+	1119UL, 1142UL, 1165UL, 1234UL, 1257UL, 1395UL,
+	1418UL, 1579UL, 1717UL, 1740UL, 1763UL, 1832UL,
+	1855UL, 1878UL, 1970UL, 1993UL, 2062UL, 2085UL,
+	2108UL, 2147UL, 2166UL, 2167UL, 2170UL, 2185UL,
+	2189UL, 2190UL, 2208UL, 2282UL, 2286UL, 2304UL,
+	2305UL, 2323UL, 2661UL, 2684UL, 2960UL, 3121UL,
+	3144UL, 3236UL, 3259UL, 3489UL, 3581UL, 5099UL,
+	7526UL, 7527UL, 7528UL, 7529UL, 7530UL, 7532UL,
+	7533UL, 7534UL, 7535UL, 7536UL, 7537UL, 7538UL,
+	7539UL, 7540UL, 7541UL, 7542UL, 7543UL, 7544UL,
+	7545UL, 7546UL, 7547UL, 7548UL, 7549UL, 7550UL,
+	7551UL, 7552UL, 7553UL, 7554UL, 7555UL, 7558UL,
+	7559UL, 7560UL, 7561UL, 7562UL, 7563UL, 7566UL,
+	7567UL, 7568UL, 7569UL, 7571UL, 7572UL, 7575UL,
+	7576UL, 7577UL, 7578UL, 7581UL, 7582UL, 7585UL,
+	7586UL, 7587UL, 7588UL, 7592UL, 7593UL, 7596UL,
+	7597UL, 7598UL, 7599UL, 7604UL, 7605UL, 7608UL,
+	7609UL, 7610UL, 7611UL, 7617UL, 7618UL, 7621UL,
+	7622UL, 7623UL, 7624UL, 7631UL, 7632UL, 7635UL,
+	7636UL, 7637UL, 7638UL, 7646UL, 7647UL, 7648UL,
+	7649UL, 7650UL, 7651UL, 7652UL, 7653UL, 7654UL,
+	7655UL, 7656UL, 7657UL, 7658UL, 7659UL, 7660UL,
+	7661UL, 7662UL, 7663UL, 7664UL, 7665UL, 7666UL,
+	7667UL, 7668UL, 7669UL, 7670UL, 7671UL, 7672UL,
+	7673UL, 7674UL, 7675UL, 7676UL, 7677UL, 7678UL,
+	7679UL, 7680UL, 7683UL, 7684UL, 7685UL, 7686UL,
+	7695UL, 7696UL, 7697UL, 7698UL, 7701UL, 7702UL,
+	7703UL, 7704UL, 7713UL, 7714UL, 7716UL, 7717UL,
+	7720UL, 7721UL, 7722UL, 7723UL, 7732UL, 7733UL,
+	7736UL, 7737UL, 7740UL, 7741UL, 7742UL, 7743UL,
+	7752UL, 7753UL, 7757UL, 7758UL, 7761UL, 7762UL,
+	7763UL, 7764UL, 7773UL, 7774UL, 7779UL, 7780UL,
+	7782UL, 7785UL, 7789UL, 7794UL, 7800UL, 7807UL,
+	7815UL, 7824UL, 7825UL, 7826UL, 7827UL, 7828UL,
+	7829UL, 7830UL, 7831UL, 7832UL, 7833UL, 7834UL,
+	7844UL, 7845UL, 7855UL, 7857UL, 7867UL, 7870UL,
+	7880UL, 7884UL, 7894UL, 7899UL, 7909UL, 7915UL,
+	7925UL, 7932UL, 7942UL, 7950UL, 7960UL, 7969UL,
+	7979UL, 7989UL, 7999UL, 8010UL, 8020UL, 11324UL,
+	11325UL, 11326UL, 11330UL, 11334UL, 11339UL, 11345UL,
+	11352UL, 11360UL, 11369UL, 11379UL, 11387UL, 11388UL,
+	11389UL, 11390UL, 11391UL, 11392UL, 11393UL, 11394UL,
+	11395UL, 11396UL, 11397UL, 11398UL, 11402UL, 11411UL,
+	11415UL, 11424UL, 11429UL, 11438UL, 11444UL, 11453UL,
+	11460UL, 11469UL, 11477UL, 11481UL, 11486UL, 11491UL,
+	11504UL, 11523UL, 11528UL, 11552UL, 11553UL, 11554UL,
+	11555UL, 11557UL, 11558UL, 11559UL, 11562UL, 11563UL,
+	11564UL, 11568UL, 11569UL, 24279UL, 24280UL, 24281UL,
+	24282UL, 24283UL, 24284UL, 24285UL, 24286UL, 24287UL,
+	24288UL, 24289UL, 24301UL, 24313UL, 24326UL, 24332UL,
+	24337UL, 24340UL, 24341UL, 24355UL, 24371UL, 24375UL,
+	24466UL, 83462UL, 83470UL, 83480UL, 83693UL, 83701UL,
+	83711UL, 83924UL, 83932UL, 84404UL, 84450UL, 84625UL,
+	84681UL, 85790UL, 85850UL, 86011UL, 86067UL, 86081UL,
+	86235UL, 86312UL, 86473UL, 86529UL, 86543UL, 86697UL,
+	86774UL, 86928UL, 87005UL, 87222UL, 87236UL, 87407UL,
+	87467UL, 87638UL, 87698UL, 87859UL, 87929UL, 88086UL,
+	88087UL, 88090UL, 88100UL, 88317UL, 88321UL, 88364UL,
+	88545UL, 88549UL, 88595UL, 88779UL, 88783UL, 89007UL,
+	89010UL, 89011UL, 89238UL, 89241UL, 89288UL, 89472UL,
+	89476UL, 89532UL, 89704UL, 89717UL, 89763UL, 89948UL,
+	89981UL, 89994UL, 90165UL, 90169UL, 90225UL, 90628UL,
+	90701UL, 90905UL, 90932UL, 91089UL, 91136UL, 91163UL,
+	91367UL, 91380UL, 91394UL, 91552UL, 91565UL, 91783UL,
+	91786UL, 91829UL, 91856UL, 92010UL, 92027UL, 92060UL,
+	92087UL, 92245UL, 92248UL, 92472UL, 92479UL, 92937UL,
+	92997UL, 93861UL, 93862UL, 93921UL, 94092UL, 94106UL,
+	94166UL, 94323UL, 94370UL, 94397UL, 94554UL, 94558UL,
+	94628UL, 94785UL, 94859UL, 95017UL, 95020UL, 95248UL,
+	95261UL, 95479UL, 95525UL, 95552UL, 95710UL, 95713UL,
+	95941UL, 96000UL, 96172UL, 96218UL, 98712UL, 98772UL,
+	98943UL, 98944UL, 99017UL, 99174UL, 99248UL, 99405UL,
+	99479UL, 99636UL, 99637UL, 99650UL, 99710UL, 99868UL,
+	99871UL, 99927UL, 100099UL, 100330UL, 100376UL, 101023UL,
+	101069UL, 102409UL, 105227UL, 105240UL, 105254UL, 105458UL,
+	105485UL, 105689UL, 107492UL, 107537UL, 107564UL, 108877UL,
+	108923UL, 111418UL, 111491UL, 111645UL, 111722UL, 111880UL,
+	111883UL, 111926UL, 112107UL, 112157UL, 112184UL, 112338UL,
+	112388UL, 112415UL, 112573UL, 112632UL, 112646UL, 112817UL,
+	112877UL, 113048UL, 113108UL, 113269UL, 113312UL, 113339UL,
+	114224UL, 114236UL, 114263UL, 114455UL, 114494UL, 115115UL,
+	115187UL, 115345UL, 115346UL, 115391UL, 115577UL, 115635UL,
+	115649UL, 116039UL, 116270UL, 116282UL, 116342UL, 116501UL,
+	116546UL, 116573UL, 116732UL, 116734UL, 116777UL, 116962UL,
+	116963UL, 117035UL, 117193UL, 117194UL, 117227UL, 117425UL,
+	117655UL, 117656UL, 117714UL, 117886UL, 117887UL, 117959UL,
+	118117UL, 118190UL, 118348UL, 118394UL, 118579UL, 118580UL,
+	118592UL, 118652UL, 118810UL, 118844UL, 119042UL, 119273UL,
+	119504UL, 119505UL, 119549UL, 119736UL, 119780UL, 119807UL,
+	119967UL, 120011UL, 120038UL, 120198UL, 120242UL, 120429UL,
+	120486UL, 120500UL, 120660UL, 120692UL, 120704UL, 120731UL,
+	120891UL, 121122UL, 121352UL, 121424UL, 122275UL, 122321UL,
+	122502UL, 122505UL, 122506UL, 122733UL, 122737UL, 122783UL,
+	123014UL, 123027UL, 123041UL, 123198UL, 123212UL, 123272UL,
+	123443UL, 123476UL, 123503UL, 123661UL, 123734UL, 124585UL,
+	124644UL, 124658UL, 124875UL, 124889UL, 125740UL, 125786UL,
+	126017UL, 126030UL, 126044UL, 126434UL, 126664UL, 126665UL,
+	126677UL, 126710UL, 126896UL, 126941UL, 126968UL, 127127UL,
+	127172UL, 127357UL, 127358UL, 127403UL, 127430UL, 127820UL,
+	128050UL, 128096UL, 128109UL, 128281UL, 128282UL, 128512UL,
+	128558UL, 128585UL, 128743UL, 128744UL, 128974UL, 128975UL,
+	128987UL, 129047UL, 129205UL, 129264UL, 129437UL, 129482UL,
+	129668UL, 129713UL, 129898UL, 129944UL, 130129UL, 130175UL,
+	130360UL, 130406UL, 130591UL, 130592UL, 130637UL, 130822UL,
+	130881UL, 130895UL, 131053UL, 131099UL, 131112UL, 131126UL,
+	131286UL, 131330UL, 131516UL, 131517UL, 131561UL, 131747UL,
+	131819UL, 132671UL, 132672UL, 132716UL, 132743UL, 132903UL,
+	132974UL, 133826UL, 133898UL, 134057UL, 134059UL, 134129UL,
+	134293UL, 134396UL, 134462UL, 134471UL, 134478UL, 134524UL,
+	134627UL, 134701UL, 134702UL, 134708UL, 134755UL, 134858UL,
+	134924UL, 134932UL, 134941UL, 134986UL, 135079UL, 135089UL,
+	135163UL, 135164UL, 135170UL, 135206UL, 135310UL, 135320UL,
+	135781UL, 135782UL, 136787UL, 136835UL, 137003UL, 137019UL,
+	137022UL, 137046UL, 137066UL, 137168UL, 137241UL, 137242UL,
+	137254UL, 137277UL, 137285UL, 137297UL, 137389UL, 137399UL,
+	137472UL, 137473UL, 137508UL, 137516UL, 137629UL, 137630UL,
+	137703UL, 137704UL, 137759UL, 137819UL, 137926UL, 137936UL,
+	137942UL, 137952UL, 137978UL, 137990UL, 138050UL, 138092UL,
+	138093UL, 138157UL, 138158UL, 138161UL, 138174UL, 138177UL,
+	138183UL, 138209UL, 138281UL, 138323UL, 138324UL, 138388UL,
+	138392UL, 138397UL, 138409UL, 138414UL, 138440UL, 138512UL,
+	138555UL, 138619UL, 138623UL, 138628UL, 138645UL, 138671UL,
+	138784UL, 138786UL, 138850UL, 138854UL, 138859UL, 139145UL,
+	139191UL, 139247UL, 139321UL, 139322UL, 139328UL, 139376UL,
+	139419UL, 139422UL, 139478UL, 139544UL, 139552UL, 139560UL,
+	139650UL, 139709UL, 140280UL, 140301UL, 140343UL, 140347UL,
+	140402UL, 140475UL, 140476UL, 140519UL, 140574UL, 140578UL,
+	140592UL, 140633UL, 140634UL, 140702UL, 140707UL, 141888UL,
+	141897UL, 141918UL, 141947UL, 142011UL, 142015UL, 142019UL,
+	142092UL, 142115UL, 142136UL, 142178UL, 142242UL, 142246UL,
+	142251UL, 143745UL, 143753UL, 143867UL, 143868UL, 145104UL,
+	145107UL, 145151UL, 145323UL, 145339UL, 145370UL, 145382UL,
+	145400UL, 145474UL, 145475UL, 145554UL, 145558UL, 145601UL,
+	145631UL, 145705UL, 145714UL, 145785UL, 145789UL, 146307UL,
+	146324UL, 146349UL, 146353UL, 146399UL, 146408UL, 146478UL,
+	146482UL, 146514UL, 146538UL, 146555UL, 146567UL, 146630UL,
+	146632UL, 146635UL, 146709UL, 146712UL, 146756UL, 146769UL,
+	146779UL, 146786UL, 146861UL, 146871UL, 146940UL, 146944UL,
+	147649UL, 147689UL, 147692UL, 147785UL, 147790UL, 147864UL,
+	147868UL, 147920UL, 148021UL, 148024UL, 148095UL, 148099UL,
+	148613UL, 148617UL, 148663UL, 148788UL, 148824UL, 148844UL,
+	148848UL, 148877UL, 148942UL, 148945UL, 149019UL, 149022UL,
+	149075UL, 149079UL, 149089UL, 149176UL, 149181UL, 149250UL,
+	149254UL, 159937UL, 159938UL, 159975UL, 160168UL, 160169UL,
+	160206UL, 160233UL, 160399UL, 160437UL, 160464UL, 160630UL,
+	160632UL, 160668UL, 160861UL, 160899UL, 160926UL, 161092UL,
+	161094UL, 161118UL, 161130UL, 161325UL, 161361UL, 161555UL,
+	161556UL, 161592UL, 161619UL, 161786UL, 161823UL, 161850UL,
+	162017UL, 162019UL, 162054UL, 162067UL, 162247UL, 162249UL,
+	162285UL, 162312UL, 162478UL, 162479UL, 162480UL, 162516UL,
+	162543UL, 162709UL, 162747UL, 163402UL, 163404UL, 163440UL,
+	163453UL, 163467UL, 163635UL, 163671UL, 163698UL, 163865UL,
+	163902UL, 164558UL, 164560UL, 167093UL, 167097UL, 167114UL,
+	177955UL, 177956UL, 177957UL, 177993UL, 178020UL, 178186UL,
+	178188UL, 178224UL, 178251UL, 178417UL, 178455UL, 179110UL,
+	179112UL, 179136UL, 179148UL, 179175UL, 179343UL, 179379UL,
+	179406UL, 179573UL, 179610UL, 182576UL, 182578UL, 185111UL,
+	185132UL, 189274UL, 189339UL, 189501UL, 189570UL, 189732UL,
+	189737UL, 189801UL, 189967UL, 189968UL, 190018UL, 190199UL,
+	190213UL, 190263UL, 190430UL, 190444UL, 190661UL, 190664UL,
+	190725UL, 191816UL, 191818UL, 191880UL, 192739UL, 192804UL,
+	192971UL, 192974UL, 193021UL, 194129UL, 194190UL, 194356UL,
+	194357UL, 194360UL, 195049UL, 195050UL, 195100UL, 195280UL,
+	195281UL, 195345UL, 195511UL, 195576UL, 195742UL, 195807UL,
+	195973UL, 195974UL, 195988UL, 196204UL, 196207UL, 196436UL,
+	196439UL, 196667UL, 196670UL, 196898UL, 196899UL, 196935UL,
+	197130UL, 197166UL, 197193UL, 197361UL, 197397UL, 197592UL,
+	197628UL, 197655UL, 197823UL, 197859UL, 197872UL, 198054UL,
+	198055UL, 198090UL, 198117UL, 198285UL, 198287UL, 198321UL,
+	198516UL, 198518UL, 198552UL, 198746UL, 198783UL, 198810UL,
+	199899UL, 199902UL, 199965UL, 200824UL, 200825UL, 201055UL,
+	201058UL, 201093UL, 202211UL, 202212UL, 202275UL, 203135UL,
+	203136UL, 203366UL, 203367UL, 203368UL, 203403UL, 204475UL,
+	204483UL, 204485UL, 204691UL, 204716UL, 204746UL, 204846UL,
+	204850UL, 204922UL, 204925UL, 205644UL, 205646UL, 205650UL,
+	205684UL, 205703UL, 205768UL, 205770UL, 205772UL, 205846UL,
+	205848UL, 205875UL, 205877UL, 205901UL, 205926UL, 206610UL,
+	206638UL, 206665UL, 206841UL, 206896UL, 207073UL, 207127UL,
+	207304UL, 207358UL, 207535UL, 207589UL, 207766UL, 207768UL,
+	207997UL, 208000UL, 208051UL, 208227UL, 208231UL, 208282UL,
+	208458UL, 208513UL, 209613UL, 209641UL, 209872UL, 209899UL,
+	210076UL, 210103UL, 210334UL, 210361UL, 210537UL, 210538UL,
+	210565UL, 210767UL, 210771UL, 211000UL, 211003UL, 211027UL,
+	211230UL, 211234UL, 211258UL, 211461UL, 211489UL, 214221UL,
+	214237UL, 214273UL, 214287UL, 214452UL, 214468UL, 214518UL,
+	214683UL, 214699UL, 214749UL, 214914UL, 214919UL, 214980UL,
+	216069UL, 216074UL, 216135UL, 217229UL, 217276UL, 217290UL,
+	218611UL, 218676UL, 219305UL, 219319UL, 219535UL, 219536UL,
+	219539UL, 219550UL, 219586UL, 219766UL, 219767UL, 219770UL,
+	219781UL, 219817UL, 219831UL, 219997UL, 219998UL, 220001UL,
+	220012UL, 220048UL, 220228UL, 220229UL, 220232UL, 220691UL,
+	220705UL, 220922UL, 220925UL, 220936UL, 220972UL, 221167UL,
+	221217UL, 221383UL, 221448UL, 221614UL, 221679UL, 221845UL,
+	222311UL, 222372UL, 222540UL, 222542UL, 222603UL, 222770UL,
+	222771UL, 222834UL, 224155UL, 224220UL, 226465UL, 226530UL,
+	228977UL, 229001UL, 229102UL, 229905UL, 229929UL, 230920UL,
+	231095UL, 231096UL, 231151UL, 231326UL, 231382UL, 232252UL,
+	232255UL, 232482UL, 233884UL, 233923UL, 234098UL, 234154UL,
+	234329UL, 235255UL, 235258UL, 238025UL, 238027UL, 238081UL,
+	241941UL, 243789UL, 243794UL, 243855UL, 250031UL, 250078UL,
+	251875UL, 251940UL, 254185UL, 265745UL, 265747UL, 265787UL,
+	296932UL, 297163UL, 297166UL, 297203UL, 331580UL, 331581UL,
+	331582UL, 331811UL, 331813UL, 331853UL, 331882UL, 332042UL,
+	348201UL, 348217UL, 348282UL, 348432UL, 348448UL, 348513UL,
+	348663UL, 348679UL, 348744UL, 348894UL, 348899UL, 348946UL,
+	348975UL, 351220UL, 351285UL, 352591UL, 352671UL, 354208UL,
+	354209UL, 355147UL, 355183UL, 355414UL, 355443UL, 355645UL,
+	355674UL, 355876UL, 362951UL, 367847UL, 367864UL, 368078UL,
+	368149UL, 368309UL, 368351UL, 386558UL, 386614UL,
+};
+
+static const uint8_t book_squares[BOOK_ENTRIES] PROGMEM = {
+	0, 12, 12, 12, 12, 12, 0, 2, 1, 1, 6, 1, 1, 1, 1, 2,
+	12, 6, 1, 1, 6, 13, 11, 3, 11, 2, 17, 18, 18, 18, 18, 7,
+	8, 16, 7, 17, 8, 13, 16, 6, 8, 6, 7, 16, 18, 16, 18, 8,
+	6, 8, 7, 18, 8, 6, 6, 13, 18, 2, 13, 17, 8, 3, 17, 7,
+	18, 7, 17, 17, 6, 6, 6, 18, 8, 6, 8, 6, 7, 6, 11, 15,
+	11, 3, 2, 3, 4, 2, 2, 3, 11, 2, 2, 3, 16, 16, 2, 2,
+	3, 3, 10, 10, 2, 2, 2, 2, 3, 3, 18, 2, 2, 2, 2, 4,
+	6, 2, 3, 3, 2, 4, 11, 2, 3, 3, 2, 11, 11, 2, 3, 3,
+	2, 10, 11, 2, 2, 3, 2, 3, 12, 2, 2, 2, 2, 3, 8, 3,
+	3, 3, 2, 3, 10, 2, 3, 3, 2, 11, 16, 2, 2, 2, 3, 3,
+	2, 2, 2, 2, 3, 3, 2, 3, 2, 10, 16, 2, 2, 2, 2, 3,
+	2, 2, 2, 2, 2, 3, 2, 2, 2, 3, 3, 15, 2, 2, 2, 2,
+	2, 2, 3, 15, 2, 3, 3, 2, 2, 2, 3, 16, 2, 3, 3, 2,
+	2, 2, 11, 16, 2, 2, 3, 2, 2, 2, 10, 16, 2, 2, 3, 2,
+	2, 2, 4, 3, 3, 3, 5, 3, 3, 3, 6, 6, 8, 1, 1, 1,
+	11, 3, 1, 1, 13, 5, 3, 3, 1, 3, 3, 3, 3, 6, 3, 3,
+	1, 3, 1, 3, 1, 3, 3, 3, 1, 3, 1, 3, 1, 12, 12, 12,
+	12, 12, 12, 12, 12, 12, 11, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+	12, 12, 11, 12, 12, 12, 12, 12, 12, 12, 11, 11, 12, 12, 12, 12,
+	12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 7, 12, 12, 3,
+	12, 6, 6, 6, 6, 6, 1, 18, 18, 6, 6, 6, 6, 6, 6, 6,
+	6, 18, 6, 8, 6, 6, 6, 8, 3, 3, 11, 2, 2, 11, 1, 11,
+	7, 13, 7, 11, 19, 13, 7, 19, 8, 6, 13, 7, 19, 7, 6, 6,
+	6, 7, 19, 11, 6, 11, 6, 13, 6, 17, 16, 13, 11, 17, 13, 8,
+	8, 16, 8, 17, 13, 7, 17, 16, 7, 17, 8, 17, 13, 7, 16, 11,
+	7, 11, 8, 7, 17, 13, 7, 16, 7, 8, 13, 17, 8, 13, 15, 7,
+	13, 16, 11, 16, 13, 8, 6, 8, 11, 8, 6, 16, 13, 11, 13, 13,
+	16, 17, 16, 8, 18, 11, 6, 18, 8, 6, 18, 13, 6, 18, 6, 16,
+	13, 16, 11, 16, 8, 13, 16, 13, 11, 8, 16, 8, 17, 7, 18, 17,
+	6, 18, 6, 18, 6, 18, 17, 11, 6, 17, 13, 7, 17, 17, 17, 17,
+	7, 18, 8, 7, 19, 8, 6, 8, 16, 8, 17, 18, 8, 13, 24, 8,
+	6, 17, 13, 8, 7, 8, 6, 18, 8, 6, 17, 7, 6, 18, 6, 18,
+	6, 18, 15, 6, 16, 8, 6, 16, 6, 16, 13, 17, 16, 8, 16, 7,
+	13, 16, 16, 9, 6, 16, 8, 6, 16, 18, 8, 18, 13, 6, 18, 16,
+	8, 16, 17, 17, 7, 18, 17, 6, 18, 6, 18, 17, 18, 17, 11, 6,
+	18, 16, 17, 18, 17, 16, 8, 16, 8, 6, 16, 8, 6, 16, 8, 16,
+	7, 6, 16, 16, 8, 6, 16, 16, 18, 6, 17, 8, 7, 18, 17, 18,
+	18, 8, 15, 7, 7, 18, 18, 6, 18, 15, 6, 17, 6, 17, 7, 6,
+	7, 6, 17, 8, 15, 7, 17, 16, 18, 16, 8, 8, 16, 8, 6, 15,
+	15, 18, 16, 15, 6, 16, 17, 17, 7, 18, 17, 18, 17, 6, 18, 17,
+	18, 17, 19, 6, 18, 7, 17, 7, 18, 19, 17, 8, 18, 8, 18, 8,
+	18, 17, 8, 18, 7, 6, 18, 8, 7, 6, 16, 8, 18, 16, 8, 18,
+	6, 17, 16, 8, 6, 17, 6, 18, 6, 18, 16, 6, 18, 16, 18, 8,
+	3, 9, 18, 18, 19, 6, 17, 18, 13, 22, 1, 9, 5, 18, 16, 16,
+	4, 5, 5, 16, 17, 16, 3, 18, 13, 1, 0, 3, 14, 18, 17, 16,
+	0, 1, 6, 9, 11, 16, 17, 16, 1, 6, 18, 18, 17, 16, 18, 8,
+	18, 19, 7, 2, 5, 18, 8, 18, 16, 18, 18, 17, 7, 0, 1, 5,
+	13, 18, 16, 1, 5, 16, 0, 2, 5, 9, 17, 1, 5, 16, 1, 5,
+	17, 16, 1, 5, 16, 9, 13, 18, 18, 17, 6, 17, 2, 13, 18, 13,
+	5, 17, 11, 16, 6, 14, 3, 13, 18, 17, 16, 2, 3, 13, 11, 18,
+	17, 17, 5, 1, 6, 14, 6, 3, 9, 18, 17, 2, 10, 5, 3, 9,
+	17, 2, 6, 18, 17, 1, 6, 14, 8, 7, 6, 9, 1, 11, 11, 9,
+	16, 6, 1, 11, 23, 18, 16, 14, 11, 2, 13, 11, 13, 8, 11, 11,
+	9, 6, 6, 6, 2, 9, 9, 17, 6, 8, 2, 3, 3, 16, 1, 16,
+	8, 7, 8, 5, 9, 1, 16, 7, 9, 23, 18, 16, 2, 17, 13, 16,
+	13, 7, 9, 2, 13, 9, 9, 6, 7, 8, 8, 0, 17, 1, 16, 18,
+	17, 8, 18, 17, 8, 6, 18, 8, 6, 18, 16, 8, 18, 8, 6, 18,
+	16, 8, 8, 16, 8, 18, 16, 8, 6, 18, 7, 6, 18, 16, 8, 7,
+	17, 16, 8, 6, 18, 17, 16, 8, 6, 18, 8, 18, 16, 8, 7, 6,
+	16, 8, 7, 18, 8, 18, 16, 6, 7, 11, 18, 17, 16, 8, 6, 18,
+	16, 8, 6, 18, 8, 18, 16, 8, 8, 6, 16, 8, 7, 18, 8, 18,
+	16, 6, 1, 17, 24, 7, 6, 18, 16, 6, 17, 16, 7, 16, 11, 6,
+	16, 11, 7, 13, 6, 16, 7, 6, 17, 13, 16, 13, 7, 13, 11, 18,
+	16, 13, 18, 17, 7, 18, 17, 6, 18, 6, 18, 6, 18, 17, 11, 18,
+	11, 17, 13, 18, 13, 17, 16, 8, 16, 8, 6, 16, 8, 16, 8, 6,
+	16, 7, 7, 16, 11, 8, 6, 16, 13, 8, 16, 13, 8, 18, 11, 6,
+	6, 16, 6, 18, 18, 11, 16, 8, 17, 16, 6, 18, 17, 18, 17, 16,
+	8, 5, 7, 6, 1, 6, 6, 1, 21, 18, 21, 13, 13, 13, 18, 6,
+	2, 6, 2, 7, 21, 3, 3, 6, 8, 17, 8, 6, 17, 6, 16, 6,
+	16, 6, 16, 6, 16, 7, 16, 22, 7, 18, 18, 6, 18, 6, 17, 8,
+	8, 6, 16, 8, 8, 6, 17, 16, 7, 18, 11, 16, 13, 8, 18, 10,
+	8, 18, 11, 17, 11, 7, 17, 18, 11, 6, 18, 11, 6, 18, 13, 6,
+	18, 13, 6, 13, 7, 11, 18, 6, 17, 11, 18, 17, 13, 11, 7, 18,
+	17, 13, 11, 22, 6, 18, 17, 13, 11, 7, 18, 17, 13, 17, 11, 18,
+	13, 11, 6, 11, 17, 18, 6, 18, 6, 18, 13, 6, 13, 13, 17, 18,
+	13, 6, 18, 6, 18, 6, 1, 8, 8, 20, 20, 6, 18, 17, 6, 18,
+	6, 0, 2, 18, 11, 6, 18, 6, 18, 17, 10, 18, 7, 6, 18, 18,
+	13, 6, 13, 8, 18, 6, 18, 18, 16, 8, 16, 16, 13, 8, 18, 17,
+	16, 18, 16, 8, 6, 18, 13, 11, 6, 18, 11, 6, 18, 11, 6, 18,
+	13, 7, 6, 11, 13, 18, 6, 18, 17, 11, 8, 13, 6, 13, 6, 7,
+	1, 18, 11, 18, 6, 18, 8, 18, 7,
+};
+
+#endif /* BOOK_DATA_H_ */
@@ -5,8 +5,7 @@
  */ 
 
 #include "buttons.h"
-#include <avr/io.h>
-#include <avr/interrupt.h>
+#include "hal.h"
 
 // Global variable to keep track of the last button state so that we 
 // can detect changes when an interrupt fires. The lower 4 bits (0 to 3)
@@ -23,24 +22,15 @@ static volatile uint8_t last_button_state;
 static volatile uint8_t button_queue[BUTTON_QUEUE_SIZE];
 static volatile int8_t queue_length;
 
+static void buttons_changed(void);
+
 // Setup interrupt if any of pins B0 to B3 change. We do this
-// using a pin change interrupt. These pins correspond to pin
-// change interrupts PCINT8 to PCINT11 which are covered by
-// Pin change interrupt 1.
+// using a pin change interrupt.
 void init_button_interrupts(void) {
-	// Enable the interrupt (see datasheet page 77)
-	PCICR |= (1<<PCIE1);
-	
-	// Make sure the interrupt flag is cleared (by writing a 
-	// 1 to it) (see datasheet page 78)
-	PCIFR |= (1<<PCIF1);
-	
-	// Choose which pins we're interested in by setting
-	// the relevant bits in the mask register (see datasheet page 78)
-	PCMSK1 |= (1<<PCINT8)|(1<<PCINT9)|(1<<PCINT10)|(1<<PCINT11);	
-	
 	// Empty the button push queue
 	queue_length = 0;
+	
+	hal_gpio_on_change(0x0F, buttons_changed);
 }
 
 int8_t button_pushed(void) {
@@ -53,8 +43,8 @@ int8_t button_pushed(void) {
 		return_value = button_queue[0];
 		
 		// Save whether interrupts were enabled and turn them off
-		int8_t interrupts_were_enabled = bit_is_set(SREG, SREG_I);
-		cli();
+		int8_t interrupts_were_enabled = hal_interrupts_enabled();
+		hal_interrupts_disable();
 		
 		for(uint8_t i = 1; i < queue_length; i++) {
 			button_queue[i-1] = button_queue[i];
@@ -63,17 +53,21 @@ int8_t button_pushed(void) {
 		
 		if(interrupts_were_enabled) {
 			// Turn them back on again
-			sei();
+			hal_interrupts_enable();
 		}
 	}
 	return return_value;
 }
 
+uint8_t buttons_held(void) {
+	return last_button_state;
+}
+
 // Interrupt handler for a change on buttons
-ISR(PCINT1_vect) {
+static void buttons_changed(void) {
 	// Get the current state of the buttons. We'll compare this with
 	// the last state to see what has changed.
-	uint8_t button_state = PINB & 0x0F;
+	uint8_t button_state = hal_gpio_read(HAL_PORT_B) & 0x0F;
 	
 	// Iterate over all the buttons and see which ones have changed.
 	// Any button pushes are added to the queue of button pushes (if
@@ -92,4 +86,6 @@ ISR(PCINT1_vect) {
 	
 	// Remember this button state
 	last_button_state = button_state;
-}
\ No newline at end of file
+}
+
+HAL_GPIO_CHANGE_HANDLER(buttons_changed)
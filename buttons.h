@@ -35,5 +35,10 @@ void init_button_interrupts(void);
  */
 int8_t button_pushed(void);
 
+/* Return the buttons which are currently held down, as a mask with bit n
+ * set for button n. Used to detect buttons pushed together.
+ */
+uint8_t buttons_held(void);
+
 
 #endif /* BUTTONS_H_ */
\ No newline at end of file
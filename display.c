@@ -6,7 +6,7 @@
 
 #include "display.h"
 #include <stdio.h>
-#include <avr/pgmspace.h>
+#include "progmem.h"
 #include "pixel_colour.h"
 #include "ledmatrix.h"
 
@@ -96,6 +96,10 @@ void update_square_colour(uint8_t x, uint8_t y, uint8_t object) {
 	else if (object == MOVESQUARE)
 	{
 		colour = MATRIX_COLOUR_MOVE;
+	} else if (object == HINTSQUARE) {
+		colour = MATRIX_COLOUR_HINT;
+	} else if (object == DANGERSQUARE) {
+		colour = MATRIX_COLOUR_DANGER;
 	} else {
 		// anything unexpected will be black
 		colour = MATRIX_COLOUR_EMPTY;
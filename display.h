@@ -26,6 +26,8 @@
 #define CURSOR			3
 #define PICKEDUPCURSOR  4
 #define MOVESQUARE      5
+#define HINTSQUARE      6
+#define DANGERSQUARE    7
 
 // matrix colour definitions
 #define MATRIX_COLOUR_EMPTY		COLOUR_BLACK
@@ -34,6 +36,8 @@
 #define MATRIX_COLOUR_CURSOR	COLOUR_ORANGE
 #define MATRIX_COLOUR_PICKED_UP_CURSOR	COLOUR_LIGHT_ORANGE
 #define MATRIX_COLOUR_MOVE		COLOUR_LIGHT_GREEN
+#define MATRIX_COLOUR_HINT		COLOUR_YELLOW
+#define MATRIX_COLOUR_DANGER	COLOUR_LIGHT_RED
 #define MATRIX_COLOUR_BG		COLOUR_LIGHT_YELLOW
 
 // initialise the display for the board, this creates the display
@@ -0,0 +1,75 @@
+/*
+ * eval.c
+ *
+ * Static evaluation of positions, with incrementally updated line scores
+ *
+ * Author: Eve
+ */
+
+#include "eval.h"
+#include "movegen.h"
+#include "progmem.h"
+#include "eval_weights.h"
+
+int16_t eval_line_delta(uint8_t own, uint8_t other) {
+	if (other == 0) {
+		// the line becomes more valuable, a completed line is worth
+		// nothing more as the win is scored separately
+		if (own == 3) {
+			return -(int16_t)pgm_read_word(&eval_line_weights[3]);
+		}
+		return (int16_t)pgm_read_word(&eval_line_weights[own + 1])
+				- (int16_t)pgm_read_word(&eval_line_weights[own]);
+	} else if (own == 0) {
+		// the opponent's line is blocked
+		return (int16_t)pgm_read_word(&eval_line_weights[other]);
+	}
+	return 0;
+}
+
+int16_t eval_square(uint8_t square) {
+	return (int16_t)pgm_read_word(&eval_square_weights[square]);
+}
+
+int16_t eval_compute_score(const Position *position) {
+	int16_t score = 0;
+	for (uint8_t line = 0; line < NUM_LINES; line++) {
+		uint8_t count_1 = position->line_counts[0][line];
+		uint8_t count_2 = position->line_counts[1][line];
+		if (count_2 == 0 && count_1 < 4) {
+			score += (int16_t)pgm_read_word(&eval_line_weights[count_1]);
+		} else if (count_1 == 0 && count_2 < 4) {
+			score -= (int16_t)pgm_read_word(&eval_line_weights[count_2]);
+		}
+	}
+	for (uint8_t square = 0; square < NUM_SQUARES; square++) {
+		uint8_t piece = position_piece_at(position, square);
+		if (piece == PLAYER_1) {
+			score += eval_square(square);
+		} else if (piece == PLAYER_2) {
+			score -= eval_square(square);
+		}
+	}
+	return score;
+}
+
+uint8_t eval_mobility(const Position *position, uint8_t player) {
+	uint32_t empty = ~position_occupied(position) & BOARD_MASK;
+	uint32_t pieces = position->pieces[player - 1];
+	uint8_t moves = 0;
+	if (position->num_pieces[player - 1] < 4) {
+		return 0;
+	}
+	while (pieces) {
+		uint8_t square = __builtin_ctzl(pieces);
+		pieces &= pieces - 1;
+		moves += __builtin_popcountl(get_neighbours(square) & empty);
+	}
+	return moves;
+}
+
+int16_t evaluate(const Position *position) {
+	int16_t score = position->score + EVAL_MOBILITY_WEIGHT
+			* ((int16_t)eval_mobility(position, PLAYER_1) - (int16_t)eval_mobility(position, PLAYER_2));
+	return position->player == PLAYER_1 ? score : -score;
+}
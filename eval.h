@@ -0,0 +1,44 @@
+/*
+ * eval.h
+ *
+ * Author: Eve
+ *
+ * Static evaluation of Teeko positions for the computer player. Each line
+ * of four holding only one player's pieces is worth a weight depending on
+ * how many of them there are, each piece is worth a weight depending on
+ * how central its square is, and in phase 2 each move a player could make
+ * is worth a mobility weight. The weights are kept in flash (see
+ * eval_weights.h). The line and square part of the score is kept up to
+ * date in the Position as pieces are added and removed, so only mobility
+ * is worked out when a position is evaluated.
+ */
+
+
+#ifndef EVAL_H_
+#define EVAL_H_
+
+#include <stdint.h>
+#include "position.h"
+
+// change in a player's line score when they add a piece to a line which
+// held own of their pieces and other of their opponent's
+int16_t eval_line_delta(uint8_t own, uint8_t other);
+
+// value of a piece on square
+int16_t eval_square(uint8_t square);
+
+// calculates the line and square score of the position (from player 1's
+// point of view) from scratch. position->score always holds this value,
+// it is kept up to date as the position changes.
+int16_t eval_compute_score(const Position *position);
+
+// returns the number of moves the player could make if they have all 4
+// pieces on the board, or 0 if they don't: the count the mobility weight
+// is applied to
+uint8_t eval_mobility(const Position *position, uint8_t player);
+
+// returns the score of the position for the player to move
+int16_t evaluate(const Position *position);
+
+
+#endif /* EVAL_H_ */
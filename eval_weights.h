@@ -0,0 +1,31 @@
+/*
+ * eval_weights.h
+ *
+ * Author: Eve
+ *
+ * Weights for the static evaluation (see eval.h). tools/tune writes a
+ * new version of this file with weights fitted to game results; these
+ * are still the hand-set weights, as no fitted set has yet been shown to
+ * play better.
+ */
+
+#ifndef EVAL_WEIGHTS_H_
+#define EVAL_WEIGHTS_H_
+
+// value of a line holding this many of a player's pieces and none of the
+// opponent's
+static const int16_t eval_line_weights[4] PROGMEM = {0, 2, 8, 32};
+
+// value of a piece on each square, the centre squares being on more lines
+static const int16_t eval_square_weights[NUM_SQUARES] PROGMEM = {
+	0, 1, 1, 1, 0,
+	1, 2, 2, 2, 1,
+	1, 2, 3, 2, 1,
+	1, 2, 2, 2, 1,
+	0, 1, 1, 1, 0,
+};
+
+// value of each move a player could make in phase 2
+#define EVAL_MOBILITY_WEIGHT 1
+
+#endif /* EVAL_WEIGHTS_H_ */
@@ -11,103 +11,113 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
-#include <avr/io.h>
-#include <avr/interrupt.h>
 #include "display.h"
-#include "terminalio.h"
+#include "movegen.h"
+#include "position.h"
 
 // Start pieces in the middle of the board
 #define CURSOR_X_START ((int)(WIDTH/2))
 #define CURSOR_Y_START ((int)(HEIGHT/2))
-#define ABS(x) ((x) >= 0 ? (x) : -(x))
-#define PICKEDUP 63
 
-uint8_t board[WIDTH][HEIGHT];
-uint8_t validmoveboard[WIDTH][HEIGHT];
-// cursor coordinates should be /* SIGNED */ to allow left and down movement.
-// All other positions should be unsigned as there are no negative coordinates.
-int8_t cursor_x;
-int8_t cursor_y;
-uint8_t cursor_visible;
-uint8_t current_player;
-uint8_t player_pieces_1;
-uint8_t player_pieces_2;
-int8_t previous_position_x;
-int8_t previous_position_y;
+// updates the colour at square (x,y) if the game is being displayed
+static void draw_square(const GameState *game, uint8_t x, uint8_t y, uint8_t object) {
+	if (game->displayed) {
+		update_square_colour(x, y, object);
+	}
+}
 
-void initialise_game(void) {
+void initialise_game(GameState *game, uint8_t displayed) {
 	
 	// initialise the display we are using
-	initialise_display();
-	
-	// initialise the board to be all empty
-	for (uint8_t x = 0; x < WIDTH; x++) {
-		for (uint8_t y = 0; y < HEIGHT; y++) {
-			board[x][y] = EMPTY_SQUARE;
-		}
+	game->displayed = displayed;
+	if (displayed) {
+		initialise_display();
 	}
 	
-	// set the starting player
-	current_player = PLAYER_1;
+	// initialise the board to be all empty, and set the starting player
+	position_clear(&game->position);
+	game->validmove_mask = 0;
+	game->hint_mask = 0;
+	game->danger_mask = 0;
+	game->longest_lines[0] = 0;
+	game->longest_lines[1] = 0;
 
 	// also set where the cursor starts
-	cursor_x = CURSOR_X_START;
-	cursor_y = CURSOR_Y_START;
-	cursor_visible = 0;
-	player_pieces_1 = 0;
-	player_pieces_2 = 0;
-	previous_position_x = PICKEDUP;
-	previous_position_y = PICKEDUP;
+	game->cursor_x = CURSOR_X_START;
+	game->cursor_y = CURSOR_Y_START;
+	game->cursor_visible = 0;
 	
 }
 
-uint8_t get_piece_at(uint8_t x, uint8_t y) {
+uint8_t get_piece_at(const GameState *game, uint8_t x, uint8_t y) {
 	// check the bounds, anything outside the bounds
 	// will be considered empty
-	if (x < 0 || x >= WIDTH || y < 0 || y >= WIDTH) {
+	if (x >= WIDTH || y >= HEIGHT) {
 		return EMPTY_SQUARE;
-	} else {
-		//if in the bounds, just index into the array
-		return board[x][y];
 	}
+	return position_piece_at(&game->position, SQUARE(x, y));
 }
 
-uint8_t get_valid_piece_at(uint8_t x, uint8_t y) {
-	// check the bounds, anything outside the bounds
-	// will be considered empty
-	if (x < 0 || x >= WIDTH || y < 0 || y >= WIDTH) {
-		return EMPTY_SQUARE;
-		} else {
-		//if in the bounds, just index into the array
-		return validmoveboard[x][y];
+// returns the object to show at (x,y) when the cursor isn't on it
+static uint8_t square_object(const GameState *game, uint8_t x, uint8_t y) {
+	uint32_t bit = SQUARE_MASK(SQUARE(x, y));
+	if (game->validmove_mask & bit) {
+		return MOVESQUARE;
+	} else if (game->hint_mask & bit) {
+		return HINTSQUARE;
+	} else if (game->danger_mask & bit) {
+		return DANGERSQUARE;
+	}
+	return get_piece_at(game, x, y);
+}
+
+// redraws the squares in mask with whatever should be shown there
+static void redraw_squares(const GameState *game, uint32_t mask) {
+	if (!game->displayed) {
+		return;
+	}
+	while (mask) {
+		uint8_t square = __builtin_ctzl(mask);
+		mask &= mask - 1;
+		update_square_colour(SQUARE_X(square), SQUARE_Y(square),
+				square_object(game, SQUARE_X(square), SQUARE_Y(square)));
 	}
 }
 
-void flash_cursor(void) {
-	uint8_t valid_at_cursor = validmoveboard[cursor_x][cursor_y];
-	if (cursor_visible) {
+// reads the squares the player to move must block off the position's
+// threat masks, and redraws the squares that have changed
+static void update_danger_leds(GameState *game) {
+	uint32_t old_mask = game->danger_mask;
+	game->danger_mask = winning_squares(&game->position, OPPONENT(game->position.player));
+	redraw_squares(game, old_mask ^ game->danger_mask);
+}
+
+// recalculates the longest run of pieces for the given player
+static void update_longest_line(GameState *game, uint8_t player) {
+	game->longest_lines[player - 1] = position_longest_run(&game->position, player);
+}
+
+void flash_cursor(GameState *game) {
+	int8_t cursor_x = game->cursor_x;
+	int8_t cursor_y = game->cursor_y;
+	if (game->cursor_visible) {
 		// we need to flash the cursor off, it should be replaced by
-		// the colour of the piece which is at that location
-		uint8_t piece_at_cursor = get_piece_at(cursor_x, cursor_y);
-		if (valid_at_cursor) {
-			update_square_colour(cursor_x, cursor_y, piece_at_cursor);
-		} else {
-			update_square_colour(cursor_x, cursor_y, piece_at_cursor);
-		}
-		
+		// the colour of the piece which is at that location (or the
+		// valid move or hint square colour)
+		draw_square(game, cursor_x, cursor_y, square_object(game, cursor_x, cursor_y));
 	} else {
 		// we need to flash the cursor on
 		//picked up?
 		//use other colour?
 		//not? this one:
-		if (previous_position_x == PICKEDUP && previous_position_y == PICKEDUP){
-			update_square_colour(cursor_x, cursor_y, CURSOR);
+		if (game->position.lifted == NO_SQUARE){
+			draw_square(game, cursor_x, cursor_y, CURSOR);
 		}
-		else{// if (previous_position_x != PICKEDUP && previous_position_y != PICKEDUP) 
-			update_square_colour(cursor_x, cursor_y, PICKEDUPCURSOR);
+		else{
+			draw_square(game, cursor_x, cursor_y, PICKEDUPCURSOR);
 		}
 	}
-	cursor_visible = 1 - cursor_visible; //alternate between 0 and 1
+	game->cursor_visible = 1 - game->cursor_visible; //alternate between 0 and 1
 }
 
 // determines whether the move wanted to make is a valid move or not.
@@ -115,72 +125,45 @@ void flash_cursor(void) {
 // up yet, then considers of there is less than 4 pieces on the board, then finally
 // considers whether a piece has been picked up and if it is within the 8 surrounding 
 // squares. 
-uint8_t valid_move(int8_t x, int8_t y) {
-	int8_t valid_x;
-	int8_t valid_y;
+uint8_t valid_move(const GameState *game, int8_t x, int8_t y) {
 	uint8_t player;
-	int8_t player_pieces;
-	
+	uint32_t bit;
 	
-	valid_x = 0;
-	valid_y = 0;
-	player = get_player();
-	player_pieces = get_player_pieces(player);
+	player = get_player(game);
+	bit = SQUARE_MASK(SQUARE(x, y));
 	
-	valid_x = previous_position_x - x;
-	valid_y = previous_position_y - y;
-	
-	if (previous_position_x == PICKEDUP && previous_position_y == PICKEDUP && board[x][y] == player) {
-		if (player_pieces == 4) {
-			return 1;
-		}
-	}	
-	else if (previous_position_x == PICKEDUP && previous_position_y == PICKEDUP && board[x][y] == EMPTY_SQUARE) {
-		if (player_pieces != 4) {
-			return 1;
+	if (game->position.lifted == NO_SQUARE) {
+		if (game->position.pieces[player - 1] & bit) {
+			// picking up a piece is only allowed once all 4 are placed
+			return get_player_pieces(game, player) == 4;
 		}
-	}
-	else if (previous_position_x != PICKEDUP && previous_position_y != PICKEDUP && board[x][y] == EMPTY_SQUARE) {
-		if (ABS(valid_x) <= 1 && ABS(valid_y) <= 1) {
-			if (valid_x == 0 && valid_y == 0)
-			{
-				// not valid move
-				return 0;
-			}
-			else
-			{
-				return 1;
-			}
+		if (!(position_occupied(&game->position) & bit)) {
+			return get_player_pieces(game, player) != 4;
 		}
+		return 0;
 	}
-	return 0;
+	// a piece has been picked up, validmove_mask holds the empty squares
+	// surrounding where it was picked up from
+	return (game->validmove_mask & bit) != 0;
 }
 
 //check the header file game.h for a description of what this function should do
 // (it may contain some hints as to how to move the cursor)
-void move_display_cursor(int8_t dx, int8_t dy) {
-	uint8_t piece_at_cursor = get_piece_at(cursor_x, cursor_y);
-	uint8_t valid_at_cursor = validmoveboard[cursor_x][cursor_y];
-	if (valid_at_cursor)
-	{
-		update_square_colour(cursor_x, cursor_y, MOVESQUARE);
-	}
-	else
-	{
-		update_square_colour(cursor_x, cursor_y, piece_at_cursor);
-	}
+void move_display_cursor(GameState *game, int8_t dx, int8_t dy) {
+	draw_square(game, game->cursor_x, game->cursor_y,
+			square_object(game, game->cursor_x, game->cursor_y));
 	
-	cursor_x = (cursor_x + dx) % WIDTH;
-	cursor_y = (cursor_y + dy) % HEIGHT;
+	game->cursor_x = (game->cursor_x + dx) % WIDTH;
+	game->cursor_y = (game->cursor_y + dy) % HEIGHT;
 	
-	if (previous_position_x == PICKEDUP && previous_position_y == PICKEDUP)
+	if (game->position.lifted == NO_SQUARE)
 	{
-		update_square_colour(cursor_x, cursor_y, CURSOR);
+		draw_square(game, game->cursor_x, game->cursor_y, CURSOR);
 	}
 	else {
-		update_square_colour(cursor_x, cursor_y, PICKEDUPCURSOR);	
+		draw_square(game, game->cursor_x, game->cursor_y, PICKEDUPCURSOR);
 	}
-	cursor_visible = 1;
+	game->cursor_visible = 1;
 	
 	//print_current_player_display();
 	/*suggestions for implementation:
@@ -197,167 +180,113 @@ void move_display_cursor(int8_t dx, int8_t dy) {
 }
 
 // changes the current player.
-void toggle_player(void) {
-	if (current_player == PLAYER_1) {
-		current_player = PLAYER_2;
-	}
-	else if (current_player == PLAYER_2) {
-		current_player = PLAYER_1;
+void toggle_player(GameState *game) {
+	position_toggle_player(&game->position);
+}
+
+void valid_move_leds(GameState *game) {
+	if (game->position.lifted != NO_SQUARE) {
+		game->validmove_mask = get_neighbours(game->position.lifted)
+				& ~position_occupied(&game->position);
+		redraw_squares(game, game->validmove_mask);
 	}
 }
 
-void valid_move_leds(void) {
-	int8_t valid_x, valid_y;
+// removes the valid move squares from the LED matrix
+static void clear_valid_move_leds(GameState *game) {
+	uint32_t mask = game->validmove_mask;
+	game->validmove_mask = 0;
+	redraw_squares(game, mask);
+}
 
-	if (previous_position_x != PICKEDUP && previous_position_y != PICKEDUP) {
-		for (int8_t i = 0; i < WIDTH; i++) {
-			for (int8_t j = 0; j < HEIGHT; j++) {
-				valid_x = previous_position_x - i;
-				valid_y = previous_position_y - j;
-				if (ABS(valid_x) <= 1 && ABS(valid_y) <= 1) {
-					if (valid_x == 0 && valid_y == 0) {
-						//
-					}
-					else {
-						if (get_piece_at(i,j) == EMPTY_SQUARE) {
-							update_square_colour(i, j, MOVESQUARE);
-							validmoveboard[i][j] = MOVESQUARE;
-						}
-					}
-				}
-			}
-		}
+void show_hint(GameState *game, Move move) {
+	clear_hint(game);
+	game->hint_mask = SQUARE_MASK(move.to);
+	if (move.from != NO_SQUARE) {
+		game->hint_mask |= SQUARE_MASK(move.from);
 	}
-	
+	redraw_squares(game, game->hint_mask);
+}
+
+void clear_hint(GameState *game) {
+	uint32_t mask = game->hint_mask;
+	game->hint_mask = 0;
+	redraw_squares(game, mask);
 }
 
-void piece_placement(void) {
+void piece_placement(GameState *game) {
 	// make it display on board, put piece there in specific colour on the board
-	// move global
+	Position *position = &game->position;
+	uint8_t player = position->player;
+	int8_t cursor_x = game->cursor_x;
+	int8_t cursor_y = game->cursor_y;
+	uint8_t square = SQUARE(cursor_x, cursor_y);
 	
-	if (current_player == PLAYER_1) {	
-		if (player_pieces_1 == 4 && board[cursor_x][cursor_y] == PLAYER_1) { //pickup
-			previous_position_x = cursor_x;
-			previous_position_y = cursor_y;
-			valid_move_leds();
-			board[cursor_x][cursor_y] = EMPTY_SQUARE;
-			update_square_colour(cursor_x, cursor_y, EMPTY_SQUARE);
-			player_pieces_1 -= 1;
-			
-		}
-		else if (player_pieces_1 < 4) { //place
-			if (valid_move(cursor_x, cursor_y)) {
-				for (int8_t i = 0; i < WIDTH; i++) {
-					for (int8_t j = 0; j < HEIGHT; j++) {
-						// Function to check if 1 set in valid move board
-						if (get_valid_piece_at(i, j) == MOVESQUARE) {
-							update_square_colour(i, j, EMPTY_SQUARE);
-							validmoveboard[i][j]= EMPTY_SQUARE;
-						}
-					}
-				}
-				board[cursor_x][cursor_y] = PLAYER_1;
-				update_square_colour(cursor_x, cursor_y, PLAYER_1);
-				player_pieces_1 += 1;
-				toggle_player();
-				previous_position_x = PICKEDUP;
-				previous_position_y = PICKEDUP;
-			}
-							
-		} 
+	if (position->lifted == NO_SQUARE && get_player_pieces(game, player) == 4
+			&& (position->pieces[player - 1] & SQUARE_MASK(square))) { //pickup
+		clear_hint(game);
+		position_lift(position, square);
+		update_longest_line(game, player);
+		valid_move_leds(game);
+		draw_square(game, cursor_x, cursor_y, EMPTY_SQUARE);
 	}
-	else if (current_player == PLAYER_2) {
-		if (player_pieces_2 == 4 && board[cursor_x][cursor_y] == PLAYER_2) { //pickup
-			previous_position_x = cursor_x;
-			previous_position_y = cursor_y;
-			valid_move_leds();
-			board[cursor_x][cursor_y] = EMPTY_SQUARE;
-			update_square_colour(cursor_x, cursor_y, EMPTY_SQUARE);
-			player_pieces_2 -= 1;
-		}
-		else if (player_pieces_2 < 4) { //place
-			if (valid_move(cursor_x, cursor_y)) {
-				for (int8_t i = 0; i < WIDTH; i++) {
-					for (int8_t j = 0; j < HEIGHT; j++) {
-						// Function to check if 1 set in valid move board
-						if (get_valid_piece_at(i, j) == MOVESQUARE) {
-							update_square_colour(i, j, EMPTY_SQUARE);
-							validmoveboard[i][j]= EMPTY_SQUARE;
-						}
-					}
-				}
-				board[cursor_x][cursor_y] = PLAYER_2;
-				update_square_colour(cursor_x, cursor_y, PLAYER_2);
-				player_pieces_2 += 1;
-				toggle_player();
-				previous_position_x = PICKEDUP;
-				previous_position_y = PICKEDUP;
-			}
-			
+	else if (get_player_pieces(game, player) < 4) { //place
+		if (valid_move(game, cursor_x, cursor_y)) {
+			clear_hint(game);
+			clear_valid_move_leds(game);
+			position_drop(position, square);
+			update_longest_line(game, player);
+			draw_square(game, cursor_x, cursor_y, player);
+			update_danger_leds(game);
 		}
-		
-	} 
+	}
 	
 }
 
+void play_move(GameState *game, Move move) {
+	Position *position = &game->position;
+	uint8_t player = position->player;
+	clear_hint(game);
+	if (move.from != NO_SQUARE) {
+		position_lift(position, move.from);
+		draw_square(game, SQUARE_X(move.from), SQUARE_Y(move.from), EMPTY_SQUARE);
+	}
+	position_drop(position, move.to);
+	update_longest_line(game, player);
+	draw_square(game, SQUARE_X(move.to), SQUARE_Y(move.to), player);
+	update_danger_leds(game);
+}
+
+const Position *get_game_position(const GameState *game) {
+	return &game->position;
+}
+
 // returns the current player
-uint8_t get_player(void) {
-	return current_player;
+uint8_t get_player(const GameState *game) {
+	return game->position.player;
 }
 
-int8_t get_player_pieces(uint8_t player) {
-	if (player == PLAYER_1) {
-		return player_pieces_1;
-	} 
-	else if (player == PLAYER_2) {
-		return player_pieces_2;
+int8_t get_player_pieces(const GameState *game, uint8_t player) {
+	if (player == PLAYER_1 || player == PLAYER_2) {
+		return game->position.num_pieces[player - 1];
 	}
 	return 0;
 }
 
-uint8_t get_cursor_x(void) {
-	return cursor_x;
+uint8_t get_longest_line(const GameState *game, uint8_t player) {
+	return game->longest_lines[player - 1];
 }
 
-uint8_t get_cursor_y(void) {
-	return cursor_y;
+uint8_t get_cursor_x(const GameState *game) {
+	return game->cursor_x;
 }
 
-uint8_t is_game_over(void) {
-	uint8_t player = PLAYER_1 + PLAYER_2 - get_player();
-	for (uint8_t i = 0; i < WIDTH; i++) {
-		for (uint8_t j = 0; j < HEIGHT; j++) {
-			if (get_piece_at(i, j) == player) {
-				if (get_piece_at(i+1, j) == player) {
-					if (get_piece_at(i+2, j) == player) {
-						if (get_piece_at(i+3, j) == player) {
-							return 1;
-						}
-					}
-				}
-				else if (get_piece_at(i, j+1) == player) {
-					if (get_piece_at(i, j+2) == player) {
-						if (get_piece_at(i, j+3) == player) {
-							return 1; 
-						}
-					}
-				} else if (get_piece_at(i+1, j+1) == player) {
-					if (get_piece_at(i+2, j+2) == player) {
-						if (get_piece_at(i+3, j+3) == player) {
-							return 1; 
-						}
-					}
-				} else if (get_piece_at(i-1, j) == player) {
-					if (get_piece_at(i-2, j) == player) {
-						if (get_piece_at(i-3, j) == player) {
-							return 1; 
-						}
-					}
-				}
-			}
-		}
-	}
-			
-	// Detect if the game is over i.e. if a player has won.
-	return 0;
-}
\ No newline at end of file
+uint8_t get_cursor_y(const GameState *game) {
+	return game->cursor_y;
+}
+
+uint8_t is_game_over(const GameState *game) {
+	// the line counts are updated as pieces move, so a completed line
+	// for either player can be read off directly
+	return position_is_won(&game->position);
+}
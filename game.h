@@ -2,8 +2,14 @@
 ** game.h
 **
 ** Authors: Luke Kamols
+** Modified by Eve
 **
 ** Function prototypes for those functions available externally
+**
+** Everything about a game in progress is kept in a GameState, which the
+** caller owns and passes to each function, so several games can be held
+** (and copied) at once. Only a game initialised as displayed draws
+** itself on the LED matrix; the firmware plays one such game.
 */
 
 
@@ -11,52 +17,101 @@
 #define GAME_H_
 
 #include <stdint.h>
-
-// initialise the display of the board, this creates the internal board
-// and also updates the display of the board
-void initialise_game(void);
+#include "movegen.h"
+#include "position.h"
+
+typedef struct {
+	// the pieces on the board, whose turn it is and whether they have
+	// picked up a piece
+	Position position;
+	// squares the picked up piece may be placed on, squares of the
+	// suggested move, and squares where the opponent of the player to
+	// move would win with their next move (shown on the LED matrix)
+	uint32_t validmove_mask;
+	uint32_t hint_mask;
+	uint32_t danger_mask;
+	// length of each player's longest run of pieces, recalculated
+	// whenever that player's pieces change so the seven segment display
+	// can read it
+	volatile uint8_t longest_lines[2];
+	// cursor coordinates should be /* SIGNED */ to allow left and down
+	// movement.
+	int8_t cursor_x;
+	int8_t cursor_y;
+	uint8_t cursor_visible;
+	// 1 if this game is the one shown on the LED matrix
+	uint8_t displayed;
+} GameState;
+
+// initialise the game, this empties the board and sets the starting
+// player. If displayed is 1 it also initialises the display of the board
+// and keeps the LED matrix up to date as the game is played.
+void initialise_game(GameState *game, uint8_t displayed);
 
 // returns which piece is located at position (x,y)
 // the value returned will be SQUARE_EMPTY, SQUARE_P1 or SQUARE_P2
 // anything outside the bounds of the boards will be SQUARE_EMPTY
-uint8_t get_piece_at(uint8_t x, uint8_t y);
+uint8_t get_piece_at(const GameState *game, uint8_t x, uint8_t y);
 
 // update the cursor display, by changing whether it is visible or not
 // call this function at regular intervals to have the cursor flash
-void flash_cursor(void);
+void flash_cursor(GameState *game);
 
 // determines whether the desired move is valid or invalid
 // call this function when using led to show valid move
-uint8_t valid_move(int8_t x, int8_t y);
+uint8_t valid_move(const GameState *game, int8_t x, int8_t y);
 
 // moves the position of the cursor by (dx, dy) such that if the cursor
 // started at (cursor_x, cursor_y) then after this function is called, 
 // it should end at ( (cursor_x + dx) % WIDTH, (cursor_y + dy) % HEIGHT)
 // the cursor should be displayed after it is moved as well
-void move_display_cursor(int8_t dx, int8_t dy);
+void move_display_cursor(GameState *game, int8_t dx, int8_t dy);
 
 // toggles current player, 
 // changes between player 1 and player 2 when called. 
-void toggle_player(void); 
+void toggle_player(GameState *game);
 
 // attempt to place a piece at the current position. If successful, the
 // active player is switched.
-void piece_placement(void);
+void piece_placement(GameState *game);
+
+// works out the squares the picked up piece can be moved to and shows
+// them on the LED matrix. piece_placement calls this when a piece is
+// picked up.
+void valid_move_leds(GameState *game);
+
+// highlights the squares of a suggested move on the LED matrix (the
+// piece to pick up and where to put it), replacing any earlier hint.
+// The hint is cleared by the next move.
+void show_hint(GameState *game, Move move);
+void clear_hint(GameState *game);
+
+// plays a whole move for the player to move (used by the computer
+// player), updating the board display. No piece may be picked up.
+void play_move(GameState *game, Move move);
+
+// returns the position being played, for the computer player to search
+const Position *get_game_position(const GameState *game);
 
 // returns the player.
-uint8_t get_player(void);
+uint8_t get_player(const GameState *game);
 
 // returns the number of player pieces on the board for a specific player
-int8_t get_player_pieces(uint8_t player);
+int8_t get_player_pieces(const GameState *game, uint8_t player);
+
+// returns the length of the longest run of pieces the player has in any
+// direction. This is cached as pieces move, so it is cheap enough to call
+// from an interrupt handler.
+uint8_t get_longest_line(const GameState *game, uint8_t player);
 
 // returns x coord of cursor
-uint8_t get_cursor_x(void);
+uint8_t get_cursor_x(const GameState *game);
 
 // returns y coord of cursor
-uint8_t get_cursor_y(void);
+uint8_t get_cursor_y(const GameState *game);
 
 // returns 1 if the game is over, 0 otherwise
-uint8_t is_game_over(void);
+uint8_t is_game_over(const GameState *game);
 
 
 #endif
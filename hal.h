@@ -0,0 +1,120 @@
+/*
+ * hal.h
+ *
+ * Author: Eve
+ *
+ * A thin hardware abstraction layer between the drivers and the
+ * microcontroller: GPIO ports, the SPI master, the UART, the two periodic
+ * timers and the global interrupt flag. hal_avr.c implements it with the
+ * ATmega324A's registers and interrupt vectors. hal_host.c implements it
+ * on Linux, so the firmware can be built and run (and its parts tested
+ * and timed) off-target: the UART is the terminal, the timers and
+ * interrupts are a thread that holds a lock while a handler runs, and
+ * the SPI bytes are decoded into a model of the LED matrix.
+ *
+ * Handlers passed in here are called in interrupt context. The host keeps
+ * pointers to them, but on the AVR each is bound to its interrupt vector
+ * when the firmware is compiled, with the HAL_..._HANDLER macros below,
+ * and the pointers passed in are not used.
+ */
+
+
+#ifndef HAL_H_
+#define HAL_H_
+
+#include <stdint.h>
+
+#define HAL_PORT_A 0
+#define HAL_PORT_B 1
+#define HAL_PORT_C 2
+#define HAL_PORT_D 3
+
+// timer 0 gives the millisecond clock, timer 1 the display refresh
+#define HAL_TIMER_0 0
+#define HAL_TIMER_1 1
+
+typedef void (*HalHandler)(void);
+typedef void (*HalCharHandler)(char c);
+
+// turns interrupts on or off globally, and returns 1 if they are on.
+// They are off at reset.
+void hal_interrupts_enable(void);
+void hal_interrupts_disable(void);
+uint8_t hal_interrupts_enabled(void);
+
+// makes the pins in mask outputs (other pins are left as they are)
+void hal_gpio_set_outputs(uint8_t port, uint8_t mask);
+
+// writes a whole port, or sets or clears the pins in mask
+void hal_gpio_write(uint8_t port, uint8_t value);
+void hal_gpio_set(uint8_t port, uint8_t mask);
+void hal_gpio_clear(uint8_t port, uint8_t mask);
+
+// reads the pins of a port
+uint8_t hal_gpio_read(uint8_t port);
+
+// calls handler whenever one of the pins in mask of port B changes
+void hal_gpio_on_change(uint8_t mask, HalHandler handler);
+
+// sets up the SPI as a master. clockdivider should be one of 2, 4, 8,
+// 16, 32, 64 or 128.
+void hal_spi_setup_master(uint8_t clockdivider);
+
+// sends and receives an SPI byte, busy waiting until it has gone
+uint8_t hal_spi_send_byte(uint8_t byte);
+
+// sets up the UART. received is called with each character that
+// arrives, and transmit_ready whenever the transmit interrupt is on and
+// the UART can take another character.
+void hal_uart_init(long baudrate, HalCharHandler received, HalHandler transmit_ready);
+
+// turns the transmit ready interrupt on or off
+void hal_uart_transmit_interrupt(uint8_t enable);
+
+// hands a character to the UART, only from transmit_ready
+void hal_uart_send(char c);
+
+// calls handler every period_ms milliseconds from the given timer
+void hal_timer_start(uint8_t timer, uint16_t period_ms, HalHandler handler);
+
+#ifdef __AVR__
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+// AVR only: binds a handler to its interrupt. Each is used once, at file
+// scope after the handler, in the file that defines it. The interrupt
+// then calls the handler directly, and inlines it if it is static and
+// small (as the millisecond tick is), rather than calling through a
+// pointer, which would make it save and restore every call-clobbered
+// register.
+#define HAL_GPIO_CHANGE_HANDLER(handler) ISR(PCINT1_vect) { handler(); }
+#define HAL_UART_RECEIVED_HANDLER(handler) ISR(USART0_RX_vect) { handler(UDR0); }
+#define HAL_UART_TRANSMIT_READY_HANDLER(handler) ISR(USART0_UDRE_vect) { handler(); }
+#define HAL_TIMER_0_HANDLER(handler) ISR(TIMER0_COMPA_vect) { handler(); }
+#define HAL_TIMER_1_HANDLER(handler) ISR(TIMER1_COMPA_vect) { handler(); }
+
+// AVR only: runs timer 1 freely at the full clock rate, so that the
+// difference between two readings is the number of processor cycles
+// between them (up to 65535). Timer 1 can't also call a handler.
+void hal_cycle_counter_start(void);
+uint16_t hal_cycle_count(void);
+
+#else
+
+// the host calls the handlers through the pointers passed in instead
+#define HAL_GPIO_CHANGE_HANDLER(handler)
+#define HAL_UART_RECEIVED_HANDLER(handler)
+#define HAL_UART_TRANSMIT_READY_HANDLER(handler)
+#define HAL_TIMER_0_HANDLER(handler)
+#define HAL_TIMER_1_HANDLER(handler)
+
+// host only: sets the level of input pins (to push the buttons), and
+// reads back a pixel of the LED matrix
+void hal_host_set_pins(uint8_t port, uint8_t value);
+uint8_t hal_host_matrix_pixel(uint8_t x, uint8_t y);
+
+#endif /* __AVR__ */
+
+
+#endif /* HAL_H_ */
@@ -0,0 +1,179 @@
+/*
+ * hal_avr.c
+ *
+ * The hardware abstraction layer on the ATmega324A
+ *
+ * Author: Eve, with the SPI set up from Peter Sutton's spi.c
+ */
+
+#include "hal.h"
+
+// system clock rate in Hz
+#define SYSCLK 8000000L
+
+static volatile uint8_t *const port_registers[] = {&PORTA, &PORTB, &PORTC, &PORTD};
+static volatile uint8_t *const ddr_registers[] = {&DDRA, &DDRB, &DDRC, &DDRD};
+static volatile uint8_t *const pin_registers[] = {&PINA, &PINB, &PINC, &PIND};
+
+// the handlers passed in below are bound to their interrupts where they
+// are defined instead (see HAL_TIMER_0_HANDLER and the rest in hal.h)
+
+void hal_interrupts_enable(void) {
+	sei();
+}
+
+void hal_interrupts_disable(void) {
+	cli();
+}
+
+uint8_t hal_interrupts_enabled(void) {
+	return bit_is_set(SREG, SREG_I) != 0;
+}
+
+void hal_gpio_set_outputs(uint8_t port, uint8_t mask) {
+	*ddr_registers[port] |= mask;
+}
+
+void hal_gpio_write(uint8_t port, uint8_t value) {
+	*port_registers[port] = value;
+}
+
+void hal_gpio_set(uint8_t port, uint8_t mask) {
+	*port_registers[port] |= mask;
+}
+
+void hal_gpio_clear(uint8_t port, uint8_t mask) {
+	*port_registers[port] &= ~mask;
+}
+
+uint8_t hal_gpio_read(uint8_t port) {
+	return *pin_registers[port];
+}
+
+void hal_gpio_on_change(uint8_t mask, HalHandler handler) {
+	(void)handler;
+	// pins B0 to B7 are pin change interrupts PCINT8 to PCINT15, which
+	// are covered by pin change interrupt 1 (see datasheet page 77)
+	PCICR |= (1<<PCIE1);
+	// make sure the interrupt flag is cleared (by writing a 1 to it)
+	PCIFR |= (1<<PCIF1);
+	PCMSK1 |= mask;
+}
+
+void hal_spi_setup_master(uint8_t clockdivider) {
+	// Make the SS, MOSI and SCK pins outputs. These are pins
+	// 4, 5 and 7 of port B on the ATmega324A
+	DDRB |= (1<<4)|(1<<5)|(1<<7);
+
+	// Set the slave select (SS) line high
+	PORTB |= (1<<4);
+
+	// Set up the SPI control registers SPCR and SPSR:
+	// - SPE bit = 1 (SPI is enabled)
+	// - MSTR bit = 1 (Master Mode)
+	SPCR0 = (1<<SPE0)|(1<<MSTR0);
+
+	// Set SPR0 and SPR1 bits in SPCR and SPI2X bit in SPSR
+	// based on the given clock divider
+	// Invalid values default to the slowest speed
+	// We consider each bit in turn
+	switch(clockdivider) {
+		case 2:
+		case 8:
+		case 32:
+			SPSR0 = (1<<SPI2X0);
+			break;
+		default:
+			SPSR0 = 0;
+			break;
+	}
+	switch(clockdivider) {
+		case 128:
+			SPCR0 |= (1<<SPR00);
+			// Note this flows through to the next code block
+		case 32:
+		case 64:
+			SPCR0 |= (1<<SPR10);
+			break;
+		case 8:
+		case 16:
+			SPCR0 |= (1<<SPR00);
+			break;
+	}
+
+	// Take SS (slave select) line low
+	PORTB &= ~(1<<4);
+}
+
+uint8_t hal_spi_send_byte(uint8_t byte) {
+	// Write out the byte to the SPDR0 register. This will initiate
+	// the transfer. We then wait until the most significant byte of
+	// SPSR0 (SPIF0 bit) is set - this indicates that the transfer is
+	// complete. (The final read of SPSR0 followed by a read of SPDR0
+	// will cause the SPIF bit to be reset to 0. See page 173 of the
+	// ATmega324A datasheet.)
+	SPDR0 = byte;
+	while((SPSR0 & (1<<SPIF0)) == 0) {
+		; // wait
+	}
+	return SPDR0;
+}
+
+void hal_uart_init(long baudrate, HalCharHandler received, HalHandler transmit_ready) {
+	(void)received;
+	(void)transmit_ready;
+
+	// this differs from the datasheet formula so that we get rounding
+	// to the nearest integer while using integer division
+	UBRR0 = ((SYSCLK / (8 * baudrate)) + 1)/2 - 1;
+
+	// enable transmission and receiving, and the receive complete
+	// interrupt. The data register empty interrupt is only turned on
+	// when there is a character to send.
+	UCSR0B = (1<<RXEN0)|(1<<TXEN0)|(1<<RXCIE0);
+}
+
+void hal_uart_transmit_interrupt(uint8_t enable) {
+	if (enable) {
+		UCSR0B |= (1<<UDRIE0);
+	} else {
+		UCSR0B &= ~(1<<UDRIE0);
+	}
+}
+
+void hal_uart_send(char c) {
+	UDR0 = c;
+}
+
+void hal_timer_start(uint8_t timer, uint16_t period_ms, HalHandler handler) {
+	(void)handler;
+	if (timer == HAL_TIMER_0) {
+		// divide the clock by 64 and clear on compare match (CTC mode),
+		// 125 counts to the millisecond
+		TCNT0 = 0;
+		OCR0A = 125 * period_ms - 1;
+		TCCR0A = (1<<WGM01);
+		TCCR0B = (1<<CS01)|(1<<CS00);
+		TIMSK0 |= (1<<OCIE0A);
+		TIFR0 = (1<<OCF0A);
+	} else {
+		// divide the clock by 8 in CTC mode, 1000 counts to the
+		// millisecond
+		OCR1A = 1000 * period_ms - 1;
+		TCCR1A = 0;
+		TCCR1B = (1<<WGM12)|(1<<CS11);
+		TIMSK1 = (1<<OCIE1A);
+		TIFR1 = (1<<OCF1A);
+	}
+}
+
+void hal_cycle_counter_start(void) {
+	// normal mode, no prescaling and no interrupts
+	TIMSK1 = 0;
+	TCCR1A = 0;
+	TCCR1B = (1<<CS10);
+}
+
+uint16_t hal_cycle_count(void) {
+	return TCNT1;
+}
@@ -0,0 +1,366 @@
+/*
+ * hal_host.c
+ *
+ * The hardware abstraction layer on Linux
+ *
+ * Author: Eve
+ *
+ * The interrupts are run by one thread, which wakes for each millisecond
+ * tick, each character typed and each time the transmit interrupt is
+ * turned on. It holds a lock while it runs the handlers, and turning
+ * interrupts off takes the same lock, so a handler never runs while the
+ * main program has interrupts off, just as on the AVR. The terminal is
+ * put in raw mode so characters arrive as they are typed.
+ */
+
+#define _GNU_SOURCE
+
+#include "hal.h"
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NUM_PORTS 4
+#define NUM_TIMERS 2
+
+// the LED matrix the SPI talks to: 16 columns and 8 rows
+#define MATRIX_COLUMNS 16
+#define MATRIX_ROWS 8
+#define CMD_UPDATE_ALL 0x00
+#define CMD_UPDATE_PIXEL 0x01
+#define CMD_UPDATE_ROW 0x02
+#define CMD_UPDATE_COL 0x03
+#define CMD_SHIFT_DISPLAY 0x04
+#define CMD_CLEAR_SCREEN 0x0F
+#define NO_COMMAND 0xFF
+
+static pthread_mutex_t interrupt_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t interrupt_thread;
+static uint8_t interrupt_thread_started;
+// whether interrupts are on, and whether the lock is held, as seen from
+// each thread (the interrupt thread runs its handlers with them off)
+static __thread uint8_t interrupts_on;
+static __thread uint8_t holding_lock;
+// written to wake the interrupt thread
+static int wake_pipe[2] = {-1, -1};
+
+static uint8_t port_values[NUM_PORTS];
+static uint8_t port_outputs[NUM_PORTS];
+static uint8_t pin_values[NUM_PORTS];
+static uint8_t pin_change_mask;
+static HalHandler pin_change_handler;
+
+static HalCharHandler uart_received;
+static HalHandler uart_transmit_ready;
+static volatile uint8_t uart_transmit_enabled;
+static uint8_t uart_input_open;
+static struct termios saved_termios;
+static uint8_t termios_saved;
+// characters sent by one round of transmit interrupts
+static char transmit_buffer[256];
+static size_t transmit_length;
+
+static HalHandler timer_handlers[NUM_TIMERS];
+static uint16_t timer_periods[NUM_TIMERS];
+static uint64_t timer_due[NUM_TIMERS];
+
+static uint8_t matrix[MATRIX_COLUMNS][MATRIX_ROWS];
+static uint8_t matrix_command = NO_COMMAND;
+static uint16_t matrix_bytes;
+static uint8_t matrix_index;
+
+static uint64_t now_ms(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static void wake_interrupt_thread(void) {
+	char c = 0;
+	if (wake_pipe[1] >= 0) {
+		(void)!write(wake_pipe[1], &c, 1);
+	}
+}
+
+static void flush_transmit_buffer(void) {
+	size_t written = 0;
+	while (written < transmit_length) {
+		ssize_t n = write(STDOUT_FILENO, transmit_buffer + written, transmit_length - written);
+		if (n <= 0) {
+			break;
+		}
+		written += n;
+	}
+	transmit_length = 0;
+}
+
+// runs the handlers that are due, with the interrupt lock held
+static void run_interrupts(uint8_t input_ready) {
+	uint64_t now = now_ms();
+	if (input_ready) {
+		char input[64];
+		ssize_t count = read(STDIN_FILENO, input, sizeof(input));
+		if (count <= 0) {
+			uart_input_open = 0;
+		}
+		for (ssize_t i = 0; i < count; i++) {
+			uart_received(input[i]);
+		}
+	}
+	while (uart_transmit_enabled) {
+		uart_transmit_ready();
+		if (transmit_length == sizeof(transmit_buffer)) {
+			flush_transmit_buffer();
+		}
+	}
+	flush_transmit_buffer();
+	for (uint8_t timer = 0; timer < NUM_TIMERS; timer++) {
+		while (timer_handlers[timer] && now >= timer_due[timer]) {
+			timer_due[timer] += timer_periods[timer];
+			timer_handlers[timer]();
+		}
+	}
+}
+
+// returns the number of milliseconds until the next timer is due
+static int next_timer_wait(void) {
+	uint64_t now = now_ms();
+	int wait = -1;
+	for (uint8_t timer = 0; timer < NUM_TIMERS; timer++) {
+		if (timer_handlers[timer]) {
+			int until = timer_due[timer] > now ? (int)(timer_due[timer] - now) : 0;
+			if (wait < 0 || until < wait) {
+				wait = until;
+			}
+		}
+	}
+	return wait;
+}
+
+static void *run_interrupt_thread(void *arg) {
+	(void)arg;
+	for (;;) {
+		struct pollfd fds[2];
+		char drain[16];
+		fds[0].fd = wake_pipe[0];
+		fds[0].events = POLLIN;
+		fds[1].fd = uart_received && uart_input_open ? STDIN_FILENO : -1;
+		fds[1].events = POLLIN;
+		fds[1].revents = 0;
+		poll(fds, 2, next_timer_wait());
+		if (fds[0].revents & POLLIN) {
+			(void)!read(wake_pipe[0], drain, sizeof(drain));
+		}
+		pthread_mutex_lock(&interrupt_lock);
+		holding_lock = 1;
+		run_interrupts((fds[1].revents & (POLLIN | POLLHUP)) != 0);
+		holding_lock = 0;
+		pthread_mutex_unlock(&interrupt_lock);
+	}
+	return 0;
+}
+
+static void restore_terminal(void) {
+	if (termios_saved) {
+		tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+	}
+}
+
+void hal_interrupts_enable(void) {
+	interrupts_on = 1;
+	if (holding_lock) {
+		holding_lock = 0;
+		pthread_mutex_unlock(&interrupt_lock);
+	}
+	if (!interrupt_thread_started) {
+		interrupt_thread_started = 1;
+		if (pipe(wake_pipe) != 0) {
+			abort();
+		}
+		pthread_create(&interrupt_thread, 0, run_interrupt_thread, 0);
+	}
+}
+
+void hal_interrupts_disable(void) {
+	interrupts_on = 0;
+	if (!holding_lock) {
+		pthread_mutex_lock(&interrupt_lock);
+		holding_lock = 1;
+	}
+}
+
+uint8_t hal_interrupts_enabled(void) {
+	return interrupts_on;
+}
+
+void hal_gpio_set_outputs(uint8_t port, uint8_t mask) {
+	port_outputs[port] |= mask;
+}
+
+void hal_gpio_write(uint8_t port, uint8_t value) {
+	port_values[port] = value;
+}
+
+void hal_gpio_set(uint8_t port, uint8_t mask) {
+	port_values[port] |= mask;
+}
+
+void hal_gpio_clear(uint8_t port, uint8_t mask) {
+	port_values[port] &= ~mask;
+}
+
+uint8_t hal_gpio_read(uint8_t port) {
+	return (pin_values[port] & ~port_outputs[port]) | (port_values[port] & port_outputs[port]);
+}
+
+void hal_gpio_on_change(uint8_t mask, HalHandler handler) {
+	pin_change_handler = handler;
+	pin_change_mask |= mask;
+}
+
+void hal_host_set_pins(uint8_t port, uint8_t value) {
+	uint8_t enabled = hal_interrupts_enabled();
+	uint8_t changed = pin_values[port] ^ value;
+	hal_interrupts_disable();
+	pin_values[port] = value;
+	if (port == HAL_PORT_B && (changed & pin_change_mask) && pin_change_handler) {
+		pin_change_handler();
+	}
+	if (enabled) {
+		hal_interrupts_enable();
+	}
+}
+
+void hal_spi_setup_master(uint8_t clockdivider) {
+	(void)clockdivider;
+	matrix_command = NO_COMMAND;
+}
+
+// the number of bytes that follow each LED matrix command
+static uint16_t command_length(uint8_t command) {
+	switch (command) {
+		case CMD_UPDATE_ALL:
+			return MATRIX_COLUMNS * MATRIX_ROWS;
+		case CMD_UPDATE_PIXEL:
+			return 2;
+		case CMD_UPDATE_ROW:
+			return 1 + MATRIX_COLUMNS;
+		case CMD_UPDATE_COL:
+			return 1 + MATRIX_ROWS;
+		case CMD_SHIFT_DISPLAY:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+static void shift_matrix(uint8_t direction) {
+	uint8_t shifted[MATRIX_COLUMNS][MATRIX_ROWS];
+	int8_t dx = (direction & 0x01) ? 1 : (direction & 0x02) ? -1 : 0;
+	int8_t dy = (direction & 0x08) ? 1 : (direction & 0x04) ? -1 : 0;
+	for (int8_t x = 0; x < MATRIX_COLUMNS; x++) {
+		for (int8_t y = 0; y < MATRIX_ROWS; y++) {
+			int8_t from_x = x - dx;
+			int8_t from_y = y - dy;
+			shifted[x][y] = 0;
+			if (from_x >= 0 && from_x < MATRIX_COLUMNS && from_y >= 0 && from_y < MATRIX_ROWS) {
+				shifted[x][y] = matrix[from_x][from_y];
+			}
+		}
+	}
+	memcpy(matrix, shifted, sizeof(matrix));
+}
+
+// applies one byte of a command's data to the model of the matrix
+static void matrix_data(uint8_t byte) {
+	uint16_t n = matrix_bytes++;
+	switch (matrix_command) {
+		case CMD_UPDATE_ALL:
+			matrix[n % MATRIX_COLUMNS][n / MATRIX_COLUMNS] = byte;
+			break;
+		case CMD_UPDATE_PIXEL:
+			if (n == 0) {
+				matrix_index = byte;
+			} else {
+				matrix[matrix_index & 0x0F][(matrix_index >> 4) & 0x07] = byte;
+			}
+			break;
+		case CMD_UPDATE_ROW:
+			if (n == 0) {
+				matrix_index = byte & 0x07;
+			} else {
+				matrix[n - 1][matrix_index] = byte;
+			}
+			break;
+		case CMD_UPDATE_COL:
+			if (n == 0) {
+				matrix_index = byte & 0x0F;
+			} else {
+				matrix[matrix_index][n - 1] = byte;
+			}
+			break;
+		case CMD_SHIFT_DISPLAY:
+			shift_matrix(byte);
+			break;
+	}
+	if (matrix_bytes == command_length(matrix_command)) {
+		matrix_command = NO_COMMAND;
+	}
+}
+
+uint8_t hal_spi_send_byte(uint8_t byte) {
+	if (matrix_command != NO_COMMAND) {
+		matrix_data(byte);
+	} else if (byte == CMD_CLEAR_SCREEN) {
+		memset(matrix, 0, sizeof(matrix));
+	} else if (command_length(byte)) {
+		matrix_command = byte;
+		matrix_bytes = 0;
+	}
+	return 0;
+}
+
+uint8_t hal_host_matrix_pixel(uint8_t x, uint8_t y) {
+	return matrix[x][y];
+}
+
+void hal_uart_init(long baudrate, HalCharHandler received, HalHandler transmit_ready) {
+	(void)baudrate;
+	uart_received = received;
+	uart_transmit_ready = transmit_ready;
+	uart_input_open = 1;
+	if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &saved_termios) == 0) {
+		struct termios raw = saved_termios;
+		raw.c_lflag &= ~(ICANON | ECHO);
+		raw.c_cc[VMIN] = 1;
+		raw.c_cc[VTIME] = 0;
+		termios_saved = 1;
+		tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+		atexit(restore_terminal);
+	}
+}
+
+void hal_uart_transmit_interrupt(uint8_t enable) {
+	uint8_t was_enabled = uart_transmit_enabled;
+	uart_transmit_enabled = enable;
+	if (enable && !was_enabled) {
+		wake_interrupt_thread();
+	}
+}
+
+void hal_uart_send(char c) {
+	if (transmit_length < sizeof(transmit_buffer)) {
+		transmit_buffer[transmit_length++] = c;
+	}
+}
+
+void hal_timer_start(uint8_t timer, uint16_t period_ms, HalHandler handler) {
+	timer_periods[timer] = period_ms;
+	timer_due[timer] = now_ms() + period_ms;
+	timer_handlers[timer] = handler;
+	wake_interrupt_thread();
+}
@@ -7,8 +7,7 @@
  */ 
 
 #include "ledmatrix.h"
-#include <avr/io.h>
-#include "spi.h"
+#include "hal.h"
 
 #define CMD_UPDATE_ALL 0x00
 #define CMD_UPDATE_PIXEL 0x01
@@ -21,14 +20,14 @@ void ledmatrix_setup(void) {
 	// Setup SPI - we divide the clock by 128.
 	// (This speed guarantees the SPI buffer will never overflow on
 	// the LED matrix.)
-	spi_setup_master(128);
+	hal_spi_setup_master(128);
 }
 
 void ledmatrix_update_all(MatrixData data) {
-	(void)spi_send_byte(CMD_UPDATE_ALL);
+	(void)hal_spi_send_byte(CMD_UPDATE_ALL);
 	for(uint8_t y=0; y<MATRIX_NUM_ROWS; y++) {
 		for(uint8_t x=0; x<MATRIX_NUM_COLUMNS; x++) {
-			(void)spi_send_byte(data[x][y]);
+			(void)hal_spi_send_byte(data[x][y]);
 		}
 	}
 }
@@ -38,9 +37,9 @@ void ledmatrix_update_pixel(uint8_t x, uint8_t y, PixelColour pixel) {
 		// Position isn't valid - we ignore the request.
 		return;
 	}
-	(void)spi_send_byte(CMD_UPDATE_PIXEL);
-	(void)spi_send_byte( ((y & 0x07)<<4) | (x & 0x0F));
-	(void)spi_send_byte(pixel);
+	(void)hal_spi_send_byte(CMD_UPDATE_PIXEL);
+	(void)hal_spi_send_byte( ((y & 0x07)<<4) | (x & 0x0F));
+	(void)hal_spi_send_byte(pixel);
 }
 
 void ledmatrix_update_row(uint8_t y, MatrixRow row) {
@@ -48,10 +47,10 @@ void ledmatrix_update_row(uint8_t y, MatrixRow row) {
 		// y value is too large - we ignore the request
 		return;
 	}
-	(void)spi_send_byte(CMD_UPDATE_ROW);
-	(void)spi_send_byte(y & 0x07);	// row number
+	(void)hal_spi_send_byte(CMD_UPDATE_ROW);
+	(void)hal_spi_send_byte(y & 0x07);	// row number
 	for(uint8_t x = 0; x<MATRIX_NUM_COLUMNS; x++) {
-		(void)spi_send_byte(row[x]);
+		(void)hal_spi_send_byte(row[x]);
 	}
 }
 
@@ -60,35 +59,35 @@ void ledmatrix_update_column(uint8_t x, MatrixColumn col) {
 		// x value is too large - we ignore the request
 		return;
 	}
-	(void)spi_send_byte(CMD_UPDATE_COL);
-	(void)spi_send_byte(x & 0x0F); // column number
+	(void)hal_spi_send_byte(CMD_UPDATE_COL);
+	(void)hal_spi_send_byte(x & 0x0F); // column number
 	for(uint8_t y = 0; y<MATRIX_NUM_ROWS; y++) {
-		(void)spi_send_byte(col[y]);
+		(void)hal_spi_send_byte(col[y]);
 	}
 }
 
 void ledmatrix_shift_display_left(void) {
-	(void)spi_send_byte(CMD_SHIFT_DISPLAY);
-	(void)spi_send_byte(0x02);
+	(void)hal_spi_send_byte(CMD_SHIFT_DISPLAY);
+	(void)hal_spi_send_byte(0x02);
 }
 
 void ledmatrix_shift_display_right(void) {
-	(void)spi_send_byte(CMD_SHIFT_DISPLAY);
-	(void)spi_send_byte(0x01);
+	(void)hal_spi_send_byte(CMD_SHIFT_DISPLAY);
+	(void)hal_spi_send_byte(0x01);
 }
 
 void ledmatrix_shift_display_up(void) {
-	(void)spi_send_byte(CMD_SHIFT_DISPLAY);
-	(void)spi_send_byte(0x08);
+	(void)hal_spi_send_byte(CMD_SHIFT_DISPLAY);
+	(void)hal_spi_send_byte(0x08);
 }
 
 void ledmatrix_shift_display_down(void) {
-	(void)spi_send_byte(CMD_SHIFT_DISPLAY);
-	(void)spi_send_byte(0x04);
+	(void)hal_spi_send_byte(CMD_SHIFT_DISPLAY);
+	(void)hal_spi_send_byte(0x04);
 }
 
 void ledmatrix_clear(void) {
-	(void)spi_send_byte(CMD_CLEAR_SCREEN);
+	(void)hal_spi_send_byte(CMD_CLEAR_SCREEN);
 }
 
 void copy_matrix_column(MatrixColumn from, MatrixColumn to) {
@@ -0,0 +1,94 @@
+/*
+ * lines.c
+ *
+ * Tables describing the lines of four squares on the Teeko board
+ *
+ * Author: Eve
+ */
+
+#include "lines.h"
+#include "progmem.h"
+
+// squares from which a line of four can start in each direction, as a
+// line starting anywhere else would run off the board
+#define LINE_START_HORIZONTAL 0x00318C63UL
+#define LINE_START_VERTICAL   0x000003FFUL
+#define LINE_START_DIAGONAL   0x00000063UL
+#define LINE_START_ANTI       0x00000318UL
+
+// bitboard of each line, square (x,y) is bit (y * WIDTH + x)
+static const uint32_t line_masks[NUM_LINES] PROGMEM = {
+	// horizontal
+	0x0000000FUL, 0x0000001EUL,
+	0x000001E0UL, 0x000003C0UL,
+	0x00003C00UL, 0x00007800UL,
+	0x00078000UL, 0x000F0000UL,
+	0x00F00000UL, 0x01E00000UL,
+	// vertical
+	0x00008421UL, 0x00010842UL,
+	0x00021084UL, 0x00042108UL,
+	0x00084210UL, 0x00108420UL,
+	0x00210840UL, 0x00421080UL,
+	0x00842100UL, 0x01084200UL,
+	// diagonal, up and to the right
+	0x00041041UL, 0x00082082UL,
+	0x00820820UL, 0x01041040UL,
+	// diagonal, up and to the left
+	0x00008888UL, 0x00011110UL,
+	0x00111100UL, 0x00222200UL,
+};
+
+// the lines passing through each square, padded with NO_LINE
+static const uint8_t square_lines[NUM_SQUARES][MAX_LINES_PER_SQUARE] PROGMEM = {
+	{0, 10, 20, NO_LINE, NO_LINE, NO_LINE, NO_LINE, NO_LINE},
+	{0, 1, 11, 21, NO_LINE, NO_LINE, NO_LINE, NO_LINE},
+	{0, 1, 12, NO_LINE, NO_LINE, NO_LINE, NO_LINE, NO_LINE},
+	{0, 1, 13, 24, NO_LINE, NO_LINE, NO_LINE, NO_LINE},
+	{1, 14, 25, NO_LINE, NO_LINE, NO_LINE, NO_LINE, NO_LINE},
+	{2, 10, 15, 22, NO_LINE, NO_LINE, NO_LINE, NO_LINE},
+	{2, 3, 11, 16, 20, 23, NO_LINE, NO_LINE},
+	{2, 3, 12, 17, 21, 24, NO_LINE, NO_LINE},
+	{2, 3, 13, 18, 25, 26, NO_LINE, NO_LINE},
+	{3, 14, 19, 27, NO_LINE, NO_LINE, NO_LINE, NO_LINE},
+	{4, 10, 15, NO_LINE, NO_LINE, NO_LINE, NO_LINE, NO_LINE},
+	{4, 5, 11, 16, 22, 24, NO_LINE, NO_LINE},
+	{4, 5, 12, 17, 20, 23, 25, 26},
+	{4, 5, 13, 18, 21, 27, NO_LINE, NO_LINE},
+	{5, 14, 19, NO_LINE, NO_LINE, NO_LINE, NO_LINE, NO_LINE},
+	{6, 10, 15, 24, NO_LINE, NO_LINE, NO_LINE, NO_LINE},
+	{6, 7, 11, 16, 25, 26, NO_LINE, NO_LINE},
+	{6, 7, 12, 17, 22, 27, NO_LINE, NO_LINE},
+	{6, 7, 13, 18, 20, 23, NO_LINE, NO_LINE},
+	{7, 14, 19, 21, NO_LINE, NO_LINE, NO_LINE, NO_LINE},
+	{8, 15, 26, NO_LINE, NO_LINE, NO_LINE, NO_LINE, NO_LINE},
+	{8, 9, 16, 27, NO_LINE, NO_LINE, NO_LINE, NO_LINE},
+	{8, 9, 17, NO_LINE, NO_LINE, NO_LINE, NO_LINE, NO_LINE},
+	{8, 9, 18, 22, NO_LINE, NO_LINE, NO_LINE, NO_LINE},
+	{9, 19, 23, NO_LINE, NO_LINE, NO_LINE, NO_LINE, NO_LINE},
+};
+
+uint32_t get_line_mask(uint8_t line) {
+	return pgm_read_dword(&line_masks[line]);
+}
+
+uint8_t get_square_line(uint8_t square, uint8_t n) {
+	return pgm_read_byte(&square_lines[square][n]);
+}
+
+uint8_t has_four_in_line(uint32_t mask) {
+	// each step ANDs in the squares one further along the line, leaving
+	// the squares that start four in a row
+	if (mask & (mask >> 1) & (mask >> 2) & (mask >> 3) & LINE_START_HORIZONTAL) {
+		return 1;
+	}
+	if (mask & (mask >> 5) & (mask >> 10) & (mask >> 15) & LINE_START_VERTICAL) {
+		return 1;
+	}
+	if (mask & (mask >> 6) & (mask >> 12) & (mask >> 18) & LINE_START_DIAGONAL) {
+		return 1;
+	}
+	if (mask & (mask >> 4) & (mask >> 8) & (mask >> 12) & LINE_START_ANTI) {
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,37 @@
+/*
+ * lines.h
+ *
+ * Author: Eve
+ *
+ * A player wins Teeko by having four pieces in a line. On the 5x5 board
+ * there are 28 such lines: 10 horizontal, 10 vertical and 4 along each
+ * diagonal direction. Squares are numbered row by row, so square (x,y)
+ * is number (y * WIDTH + x).
+ */
+
+
+#ifndef LINES_H_
+#define LINES_H_
+
+#include <stdint.h>
+
+#define NUM_SQUARES 25
+#define NUM_LINES 28
+
+// no square is on more than 8 lines (the centre square is on 8)
+#define MAX_LINES_PER_SQUARE 8
+#define NO_LINE 255
+
+// returns the bitboard of squares making up the given line
+uint32_t get_line_mask(uint8_t line);
+
+// returns the n'th line passing through the given square, or NO_LINE
+// if the square is on fewer than n+1 lines
+uint8_t get_square_line(uint8_t square, uint8_t n);
+
+// returns 1 if the bitboard contains all four squares of any line, for
+// use where there are no line counts to hand
+uint8_t has_four_in_line(uint32_t mask);
+
+
+#endif /* LINES_H_ */
@@ -0,0 +1,279 @@
+/*
+ * mcts.c
+ *
+ * Monte Carlo tree search with nodes allocated from a static pool
+ *
+ * Author: Eve
+ */
+
+#include <math.h>
+#include "mcts.h"
+#include "progmem.h"
+#include "random.h"
+#include "search_memory.h"
+#include "timer0.h"
+
+#ifndef __AVR__
+#include <stdlib.h>
+#endif
+
+// node indices and visit counts only need 16 bits with the AVR's pool
+#ifdef __AVR__
+typedef uint16_t MctsCount;
+#else
+typedef uint32_t MctsCount;
+#endif
+
+#define NO_NODE ((MctsCount)-1)
+
+// a playout that hasn't ended after this many plies is called a draw
+#define PLAYOUT_LIMIT 96
+
+// weight of the exploration term in the UCT formula
+#define EXPLORATION 1.0f
+
+// scores are kept in half points for the player who made the node's move
+#define WIN_POINTS 2
+#define DRAW_POINTS 1
+
+typedef struct {
+	// the move leading to this node from its parent
+	Move move;
+	MctsCount parent;
+	// the children are num_children nodes starting at first_child, or
+	// NO_NODE until the node is expanded
+	MctsCount first_child;
+	uint8_t num_children;
+	MctsCount visits;
+	MctsCount score;
+} MctsNode;
+
+#ifdef __AVR__
+// the pool and the root position share SRAM with the alpha-beta search
+// (see search_memory.h)
+typedef struct {
+	MctsNode pool[MCTS_POOL_SIZE];
+	Position root_position;
+} MctsMemory;
+
+_Static_assert(sizeof(MctsMemory) <= SEARCH_MEMORY_SIZE, "Monte Carlo search memory too big");
+
+#define pool (((MctsMemory *)search_memory)->pool)
+#define root_position (((MctsMemory *)search_memory)->root_position)
+#else
+// too big to give every thread a copy up front, so each thread's pool is
+// allocated when it first searches
+static THREAD_LOCAL MctsNode *pool;
+static THREAD_LOCAL Position root_position;
+#endif
+static THREAD_LOCAL MctsCount pool_used;
+// the root of the tree, whose position is root_position
+static THREAD_LOCAL MctsCount root;
+
+static THREAD_LOCAL uint32_t rng_state = RANDOM_SEED;
+static THREAD_LOCAL uint32_t playouts;
+
+void mcts_seed(uint32_t seed) {
+	// xorshift must never be seeded with 0
+	rng_state = seed ? seed : RANDOM_SEED;
+}
+
+// returns the winner of the position (the player who just moved if they
+// completed a line or left the player to move stuck), or EMPTY_SQUARE if
+// the game isn't over
+static uint8_t winner(const Position *position) {
+	if (position_is_lost(position)) {
+		return OPPONENT(position->player);
+	}
+	return EMPTY_SQUARE;
+}
+
+// plays random moves (or a winning move when there is one) until someone
+// wins or PLAYOUT_LIMIT is reached, and returns the winner or
+// EMPTY_SQUARE
+static uint8_t playout(Position *position) {
+	MoveList list;
+	Move move;
+	for (uint8_t ply = 0; ply < PLAYOUT_LIMIT; ply++) {
+		uint8_t won_by = winner(position);
+		if (won_by != EMPTY_SQUARE) {
+			return won_by;
+		}
+		if (find_winning_move(position, &move)) {
+			make_move(position, move);
+			continue;
+		}
+		generate_moves(position, &list);
+		make_move(position, list.moves[random_number(&rng_state) % list.count]);
+	}
+	return winner(position);
+}
+
+// gives the node a child for each legal move, if the pool has room
+static void expand(const Position *position, MctsCount index) {
+	MoveList list;
+	MctsNode *node = &pool[index];
+	uint8_t count = generate_moves(position, &list);
+	if (count == 0 || MCTS_POOL_SIZE - pool_used < count) {
+		return;
+	}
+	node->first_child = pool_used;
+	node->num_children = count;
+	for (uint8_t i = 0; i < count; i++) {
+		MctsNode *child = &pool[pool_used++];
+		child->move = list.moves[i];
+		child->parent = index;
+		child->first_child = NO_NODE;
+		child->num_children = 0;
+		child->visits = 0;
+		child->score = 0;
+	}
+}
+
+// picks the child with the highest upper confidence bound, trying each
+// unvisited child first
+static MctsCount select_child(const MctsNode *node) {
+	MctsCount best = node->first_child;
+	float best_value = -1.0f;
+	float log_visits = logf((float)node->visits);
+	for (uint8_t i = 0; i < node->num_children; i++) {
+		MctsCount index = node->first_child + i;
+		const MctsNode *child = &pool[index];
+		if (child->visits == 0) {
+			return index;
+		}
+		float value = (float)child->score / (WIN_POINTS * (float)child->visits)
+				+ EXPLORATION * sqrtf(log_visits / (float)child->visits);
+		if (value > best_value) {
+			best_value = value;
+			best = index;
+		}
+	}
+	return best;
+}
+
+void mcts_search_start(const Position *position) {
+#ifndef __AVR__
+	if (!pool) {
+		pool = malloc(MCTS_POOL_SIZE * sizeof(MctsNode));
+		if (!pool) {
+			abort();
+		}
+	}
+#endif
+	root_position = *position;
+	root = 0;
+	pool_used = 1;
+	pool[0].parent = NO_NODE;
+	pool[0].first_child = NO_NODE;
+	pool[0].num_children = 0;
+	pool[0].visits = 0;
+	pool[0].score = 0;
+	expand(position, 0);
+	playouts = 0;
+}
+
+uint8_t mcts_search_step(uint16_t max_playouts) {
+	Position search_position;
+
+	while (max_playouts--) {
+		MctsCount index = root;
+		// stop before the counts could overflow
+		if (pool[root].visits >= NO_NODE / WIN_POINTS - 1) {
+			return 0;
+		}
+		search_position = root_position;
+
+		// walk down the tree to a leaf
+		while (pool[index].num_children != 0) {
+			index = select_child(&pool[index]);
+			make_move(&search_position, pool[index].move);
+		}
+		// grow the tree by one level below a leaf that has been visited
+		// before, and run the playout from one of the new children
+		if (pool[index].visits != 0 && winner(&search_position) == EMPTY_SQUARE) {
+			expand(&search_position, index);
+			if (pool[index].num_children != 0) {
+				index = pool[index].first_child;
+				make_move(&search_position, pool[index].move);
+			}
+		}
+
+		// the player who made the leaf's move is the one not to move now
+		uint8_t mover = OPPONENT(search_position.player);
+		uint8_t won_by = playout(&search_position);
+		while (index != NO_NODE) {
+			MctsNode *node = &pool[index];
+			node->visits++;
+			if (won_by == mover) {
+				node->score += WIN_POINTS;
+			} else if (won_by == EMPTY_SQUARE) {
+				node->score += DRAW_POINTS;
+			}
+			mover = OPPONENT(mover);
+			index = node->parent;
+		}
+		playouts++;
+	}
+	return 1;
+}
+
+uint8_t mcts_search_advance(const Position *position) {
+	MctsNode *node = &pool[root];
+	for (uint8_t i = 0; i < node->num_children; i++) {
+		MctsCount index = node->first_child + i;
+		Position child_position = root_position;
+		make_move(&child_position, pool[index].move);
+		if (child_position.key == position->key
+				&& child_position.pieces[0] == position->pieces[0]
+				&& child_position.pieces[1] == position->pieces[1]) {
+			if (winner(&child_position) != EMPTY_SQUARE) {
+				return 0;
+			}
+			// the rest of the tree is left where it is, unreachable
+			root = index;
+			root_position = child_position;
+			pool[root].parent = NO_NODE;
+			if (pool[root].num_children == 0) {
+				expand(&root_position, root);
+			}
+			return pool[root].num_children != 0;
+		}
+	}
+	return 0;
+}
+
+Move mcts_best_move(void) {
+	// the most visited move is the most reliable
+	MctsCount best = pool[root].first_child;
+	for (uint8_t i = 1; i < pool[root].num_children; i++) {
+		if (pool[pool[root].first_child + i].visits > pool[best].visits) {
+			best = pool[root].first_child + i;
+		}
+	}
+	return pool[best].move;
+}
+
+Move mcts_choose_move(const Position *position, uint16_t budget, uint32_t max_playouts) {
+	uint32_t start_time = get_current_time();
+	mcts_search_start(position);
+	if (max_playouts) {
+		while (playouts < max_playouts
+				&& mcts_search_step(max_playouts - playouts > 0xFFFF ? 0xFFFF : max_playouts - playouts)) {
+			;
+		}
+	} else {
+		while (get_current_time() - start_time < budget && mcts_search_step(1)) {
+			;
+		}
+	}
+	return mcts_best_move();
+}
+
+uint32_t mcts_last_playouts(void) {
+	return playouts;
+}
+
+uint32_t mcts_last_nodes(void) {
+	return pool_used;
+}
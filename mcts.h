@@ -0,0 +1,69 @@
+/*
+ * mcts.h
+ *
+ * Author: Eve
+ *
+ * A Monte Carlo tree search (UCT) computer player. Tree nodes come from a
+ * fixed pool rather than the heap, so the strength it can reach is set by
+ * MCTS_POOL_SIZE: a few dozen nodes on the AVR, around a million on the
+ * host. Once the pool is full the tree stops growing and the remaining
+ * time goes on more playouts from its leaves. Like the alpha-beta search
+ * it can be run a slice at a time from the game loop. On the AVR the pool
+ * shares SRAM with the alpha-beta search (see search_memory.h).
+ */
+
+
+#ifndef MCTS_H_
+#define MCTS_H_
+
+#include <stdint.h>
+#include "movegen.h"
+#include "position.h"
+
+#ifndef MCTS_POOL_SIZE
+#ifdef __AVR__
+#define MCTS_POOL_SIZE 32
+#else
+#define MCTS_POOL_SIZE 1048576UL
+#endif
+#endif
+
+// playouts run per call to mcts_search_step from the game loop
+#define MCTS_SLICE_PLAYOUTS 2
+
+// seeds the random number generator used for playouts
+void mcts_seed(uint32_t seed);
+
+// begins a new search of the position, with the same requirements as
+// mcts_choose_move
+void mcts_search_start(const Position *position);
+
+// runs max_playouts more playouts, then returns 1, or returns 0 if the
+// search can't go on because the root's visit count is about to overflow
+uint8_t mcts_search_step(uint16_t max_playouts);
+
+// moves the root of the tree down to the child for position, if it is
+// one move on from the root, so the search carries on in the subtree
+// grown so far. This is how the search ponders: it searches the
+// opponent's position while they think, then advances to the position
+// they leave. Returns 0 if position isn't one of the root's children,
+// the game is over there or there is no room left to expand it, in which
+// case a new search must be started.
+uint8_t mcts_search_advance(const Position *position);
+
+// returns the most visited move at the root so far
+Move mcts_best_move(void);
+
+// runs playouts from the position for budget milliseconds, or instead
+// runs exactly max_playouts of them if that is not 0, and returns the
+// most visited move. The position must not have a piece lifted, must not
+// be won and the player to move must have a legal move.
+Move mcts_choose_move(const Position *position, uint16_t budget, uint32_t max_playouts);
+
+// returns the number of playouts and the number of tree nodes used by
+// the current or last search
+uint32_t mcts_last_playouts(void);
+uint32_t mcts_last_nodes(void);
+
+
+#endif /* MCTS_H_ */
@@ -0,0 +1,145 @@
+/*
+ * movegen.c
+ *
+ * Legal move generation and make/unmake for Teeko positions
+ *
+ * Author: Eve
+ */
+
+#include "movegen.h"
+#include "progmem.h"
+
+// the squares surrounding each square, not wrapping around the edges
+static const uint32_t neighbour_masks[NUM_SQUARES] PROGMEM = {
+	0x00000062UL, 0x000000E5UL, 0x000001CAUL, 0x00000394UL, 0x00000308UL,
+	0x00000C43UL, 0x00001CA7UL, 0x0000394EUL, 0x0000729CUL, 0x00006118UL,
+	0x00018860UL, 0x000394E0UL, 0x000729C0UL, 0x000E5380UL, 0x000C2300UL,
+	0x00310C00UL, 0x00729C00UL, 0x00E53800UL, 0x01CA7000UL, 0x01846000UL,
+	0x00218000UL, 0x00538000UL, 0x00A70000UL, 0x014E0000UL, 0x008C0000UL,
+};
+
+uint32_t get_neighbours(uint8_t square) {
+	return pgm_read_dword(&neighbour_masks[square]);
+}
+
+uint8_t generate_moves(const Position *position, MoveList *list) {
+	uint8_t player = position->player;
+	uint32_t empty = ~position_occupied(position) & BOARD_MASK;
+	uint8_t count = 0;
+	
+	if (position->num_pieces[player - 1] < 4) {
+		// phase 1, drop a piece on any empty square
+		while (empty) {
+			uint8_t to = __builtin_ctzl(empty);
+			empty &= empty - 1;
+			list->moves[count].from = NO_SQUARE;
+			list->moves[count].to = to;
+			count++;
+		}
+	} else {
+		// phase 2, slide a piece to an empty neighbouring square
+		uint32_t pieces = position->pieces[player - 1];
+		while (pieces) {
+			uint8_t from = __builtin_ctzl(pieces);
+			uint32_t targets = get_neighbours(from) & empty;
+			pieces &= pieces - 1;
+			while (targets) {
+				uint8_t to = __builtin_ctzl(targets);
+				targets &= targets - 1;
+				list->moves[count].from = from;
+				list->moves[count].to = to;
+				count++;
+			}
+		}
+	}
+	list->count = count;
+	return count;
+}
+
+uint8_t pieces_are_stuck(uint32_t own, uint32_t other) {
+	uint32_t empty = ~(own | other) & BOARD_MASK;
+	if (__builtin_popcountl(own) < 4) {
+		return 0;
+	}
+	while (own) {
+		if (get_neighbours(__builtin_ctzl(own)) & empty) {
+			return 0;
+		}
+		own &= own - 1;
+	}
+	return 1;
+}
+
+uint8_t position_is_stuck(const Position *position) {
+	uint8_t player = position->player;
+	// checked first as it is cheap, and rules out most positions
+	if (position->num_pieces[player - 1] < 4) {
+		return 0;
+	}
+	return pieces_are_stuck(position->pieces[player - 1], position->pieces[OPPONENT(player) - 1]);
+}
+
+uint8_t position_is_lost(const Position *position) {
+	return position_is_won(position) || position_is_stuck(position);
+}
+
+uint32_t winning_squares(const Position *position, uint8_t player) {
+	uint32_t own = position->pieces[player - 1];
+	uint32_t lines = position->threat_lines[player - 1];
+	uint32_t squares = 0;
+	if (position->num_pieces[player - 1] < 4) {
+		return position->threats[player - 1];
+	}
+	while (lines) {
+		uint32_t line_mask = get_line_mask(__builtin_ctzl(lines));
+		uint8_t target = __builtin_ctzl(line_mask & ~own);
+		lines &= lines - 1;
+		if (get_neighbours(target) & own & ~line_mask) {
+			squares |= SQUARE_MASK(target);
+		}
+	}
+	return squares;
+}
+
+uint8_t find_winning_move(const Position *position, Move *move) {
+	uint8_t player = position->player;
+	uint32_t squares = winning_squares(position, player);
+	if (!squares) {
+		return 0;
+	}
+	move->from = NO_SQUARE;
+	move->to = __builtin_ctzl(squares);
+	if (position->num_pieces[player - 1] == 4) {
+		// slide in a piece that isn't on the line the target completes
+		uint32_t own = position->pieces[player - 1];
+		uint32_t lines = position->threat_lines[player - 1];
+		uint32_t movers = 0;
+		while (lines) {
+			uint32_t line_mask = get_line_mask(__builtin_ctzl(lines));
+			lines &= lines - 1;
+			if (line_mask & SQUARE_MASK(move->to)) {
+				movers |= own & ~line_mask;
+			}
+		}
+		move->from = __builtin_ctzl(movers & get_neighbours(move->to));
+	}
+	return 1;
+}
+
+void make_move(Position *position, Move move) {
+	uint8_t player = position->player;
+	if (move.from != NO_SQUARE) {
+		position_remove_piece(position, player, move.from);
+	}
+	position_add_piece(position, player, move.to);
+	position_toggle_player(position);
+}
+
+void unmake_move(Position *position, Move move) {
+	uint8_t player = OPPONENT(position->player);
+	position_remove_piece(position, player, move.to);
+	if (move.from != NO_SQUARE) {
+		position_add_piece(position, player, move.from);
+	}
+	position_toggle_player(position);
+}
@@ -0,0 +1,73 @@
+/*
+ * movegen.h
+ *
+ * Author: Eve
+ *
+ * Legal move generation for Teeko. In phase 1 a move drops a new piece on
+ * any empty square. Once the player to move has all 4 pieces on the board
+ * (phase 2) a move slides one of them to an adjacent empty square.
+ */
+
+
+#ifndef MOVEGEN_H_
+#define MOVEGEN_H_
+
+#include <stdint.h>
+#include "position.h"
+
+// 4 pieces with at most 8 neighbours each in phase 2, and at most 25
+// empty squares in phase 1
+#define MAX_MOVES 32
+
+// from is NO_SQUARE for a phase 1 drop
+typedef struct {
+	uint8_t from;
+	uint8_t to;
+} Move;
+
+typedef struct {
+	Move moves[MAX_MOVES];
+	uint8_t count;
+} MoveList;
+
+// returns the mask of the (up to 8) squares surrounding square
+uint32_t get_neighbours(uint8_t square);
+
+// fills list with every legal move for the player to move and returns the
+// number of moves. The position must not have a piece lifted. Moves are
+// generated even if the game has already been won.
+uint8_t generate_moves(const Position *position, MoveList *list);
+
+// returns the squares the player could move a piece to next and complete
+// a line: in phase 1 the position's threat squares, and in phase 2 those
+// threat squares next to one of the player's pieces that isn't on the
+// line being completed. Only one square can be blocked per move, so a
+// player facing two of these squares from their opponent has lost.
+uint32_t winning_squares(const Position *position, uint8_t player);
+
+// returns 1 if the player with the pieces own, against the pieces other,
+// has no legal move. That can only happen in phase 2, with every one of
+// their pieces boxed in, and it takes at least five pieces to box in
+// four, so never in a real game.
+uint8_t pieces_are_stuck(uint32_t own, uint32_t other);
+
+// returns 1 if the player to move has no legal move, as above. The
+// position must not have a piece lifted.
+uint8_t position_is_stuck(const Position *position);
+
+// returns 1 if the player to move has lost: the player who just moved
+// completed a line, or left them without a legal move. A player who
+// cannot move loses, everywhere from the solver to the computer players.
+uint8_t position_is_lost(const Position *position);
+
+// finds a move that wins straight away for the player to move. Returns 1
+// and sets *move if there is one, or 0 if not.
+uint8_t find_winning_move(const Position *position, Move *move);
+
+// plays a move generated by generate_moves, and takes it back again.
+// unmake_move must be given the position make_move left behind.
+void make_move(Position *position, Move move);
+void unmake_move(Position *position, Move move);
+
+
+#endif /* MOVEGEN_H_ */
@@ -23,6 +23,7 @@ typedef uint8_t PixelColour;
 #define COLOUR_LIGHT_ORANGE 0x13
 #define COLOUR_LIGHT_YELLOW 0x35
 #define COLOUR_LIGHT_GREEN	0x11
+#define COLOUR_LIGHT_RED	0x05
 
 
 #endif /* PIXEL_COLOUR_H_ */
\ No newline at end of file
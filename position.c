@@ -0,0 +1,193 @@
+/*
+ * position.c
+ *
+ * Bitboard representation of a Teeko position
+ *
+ * Author: Eve
+ */
+
+#include "position.h"
+#include "eval.h"
+
+#define COLUMN_0 0x00108421UL
+#define COLUMN_4 0x01084210UL
+
+void position_clear(Position *position) {
+	position->pieces[0] = 0;
+	position->pieces[1] = 0;
+	for (uint8_t line = 0; line < NUM_LINES; line++) {
+		position->line_counts[0][line] = 0;
+		position->line_counts[1][line] = 0;
+	}
+	position->lines_completed[0] = 0;
+	position->lines_completed[1] = 0;
+	position->threat_lines[0] = 0;
+	position->threat_lines[1] = 0;
+	position->threats[0] = 0;
+	position->threats[1] = 0;
+	position->num_pieces[0] = 0;
+	position->num_pieces[1] = 0;
+	position->player = PLAYER_1;
+	position->lifted = NO_SQUARE;
+	position->key = 0;
+	position->score = 0;
+}
+
+uint8_t position_piece_at(const Position *position, uint8_t square) {
+	uint32_t bit = SQUARE_MASK(square);
+	if (position->pieces[0] & bit) {
+		return PLAYER_1;
+	} else if (position->pieces[1] & bit) {
+		return PLAYER_2;
+	}
+	return EMPTY_SQUARE;
+}
+
+uint32_t position_occupied(const Position *position) {
+	return position->pieces[0] | position->pieces[1];
+}
+
+// sets or clears the line's bit in each player's threat_lines
+static void update_threat_line(Position *position, uint8_t line) {
+	uint8_t count_1 = position->line_counts[0][line];
+	uint8_t count_2 = position->line_counts[1][line];
+	uint32_t bit = (uint32_t)1 << line;
+	position->threat_lines[0] &= ~bit;
+	position->threat_lines[1] &= ~bit;
+	if (count_1 == 3 && count_2 == 0) {
+		position->threat_lines[0] |= bit;
+	} else if (count_2 == 3 && count_1 == 0) {
+		position->threat_lines[1] |= bit;
+	}
+}
+
+// rebuilds the threat squares from the threat lines, of which there are
+// rarely more than one or two
+static void update_threats(Position *position) {
+	for (uint8_t n = 0; n < 2; n++) {
+		uint32_t lines = position->threat_lines[n];
+		uint32_t threats = 0;
+		while (lines) {
+			threats |= get_line_mask(__builtin_ctzl(lines));
+			lines &= lines - 1;
+		}
+		position->threats[n] = threats & ~position->pieces[n];
+	}
+}
+
+void position_add_piece(Position *position, uint8_t player, uint8_t square) {
+	uint8_t *counts = position->line_counts[player - 1];
+	const uint8_t *other_counts = position->line_counts[OPPONENT(player) - 1];
+	int16_t score = eval_square(square);
+	position->pieces[player - 1] |= SQUARE_MASK(square);
+	position->num_pieces[player - 1]++;
+	position->key ^= zobrist_piece_key(player, square);
+	for (uint8_t n = 0; n < MAX_LINES_PER_SQUARE; n++) {
+		uint8_t line = get_square_line(square, n);
+		if (line == NO_LINE) {
+			break;
+		}
+		score += eval_line_delta(counts[line], other_counts[line]);
+		if (++counts[line] == 4) {
+			position->lines_completed[player - 1]++;
+		}
+		update_threat_line(position, line);
+	}
+	update_threats(position);
+	position->score += player == PLAYER_1 ? score : -score;
+}
+
+void position_remove_piece(Position *position, uint8_t player, uint8_t square) {
+	uint8_t *counts = position->line_counts[player - 1];
+	const uint8_t *other_counts = position->line_counts[OPPONENT(player) - 1];
+	int16_t score = eval_square(square);
+	position->pieces[player - 1] &= ~SQUARE_MASK(square);
+	position->num_pieces[player - 1]--;
+	position->key ^= zobrist_piece_key(player, square);
+	for (uint8_t n = 0; n < MAX_LINES_PER_SQUARE; n++) {
+		uint8_t line = get_square_line(square, n);
+		if (line == NO_LINE) {
+			break;
+		}
+		if (counts[line]-- == 4) {
+			position->lines_completed[player - 1]--;
+		}
+		score += eval_line_delta(counts[line], other_counts[line]);
+		update_threat_line(position, line);
+	}
+	update_threats(position);
+	position->score -= player == PLAYER_1 ? score : -score;
+}
+
+void position_toggle_player(Position *position) {
+	position->player = OPPONENT(position->player);
+	position->key ^= zobrist_player_key();
+}
+
+void position_lift(Position *position, uint8_t square) {
+	position_remove_piece(position, position->player, square);
+	position->lifted = square;
+	position->key ^= zobrist_lifted_key(square);
+}
+
+void position_drop(Position *position, uint8_t square) {
+	if (position->lifted != NO_SQUARE) {
+		position->key ^= zobrist_lifted_key(position->lifted);
+		position->lifted = NO_SQUARE;
+	}
+	position_add_piece(position, position->player, square);
+	position_toggle_player(position);
+}
+
+ZobristKey position_compute_key(const Position *position) {
+	ZobristKey key = 0;
+	for (uint8_t square = 0; square < NUM_SQUARES; square++) {
+		uint8_t piece = position_piece_at(position, square);
+		if (piece != EMPTY_SQUARE) {
+			key ^= zobrist_piece_key(piece, square);
+		}
+	}
+	if (position->lifted != NO_SQUARE) {
+		key ^= zobrist_lifted_key(position->lifted);
+	}
+	if (position->player == PLAYER_2) {
+		key ^= zobrist_player_key();
+	}
+	return key;
+}
+
+uint8_t position_is_won(const Position *position) {
+	return position->lines_completed[0] != 0 || position->lines_completed[1] != 0;
+}
+
+// returns the length of the longest run of squares in mask, where step
+// moves from a square to the next one along the run. edge holds the
+// squares whose next square would wrap onto another row.
+static uint8_t longest_run(uint32_t mask, uint8_t step, uint32_t edge) {
+	uint32_t run = mask;
+	uint8_t length = 0;
+	// after each pass run holds the squares which start a run one longer
+	while (run) {
+		length++;
+		run = mask & (run >> step) & ~edge;
+	}
+	return length;
+}
+
+uint8_t position_longest_run(const Position *position, uint8_t player) {
+	uint32_t mask = position->pieces[player - 1];
+	uint8_t longest = longest_run(mask, 1, COLUMN_4);
+	uint8_t length = longest_run(mask, WIDTH, 0);
+	if (length > longest) {
+		longest = length;
+	}
+	length = longest_run(mask, WIDTH + 1, COLUMN_4);
+	if (length > longest) {
+		longest = length;
+	}
+	length = longest_run(mask, WIDTH - 1, COLUMN_0);
+	if (length > longest) {
+		longest = length;
+	}
+	return longest;
+}
@@ -0,0 +1,97 @@
+/*
+ * position.h
+ *
+ * Author: Eve
+ *
+ * A Teeko position: where each player's pieces are and whose turn it is.
+ * The board is stored as one bitboard per player, with square (x,y) at
+ * bit (y * WIDTH + x). The number of pieces each player has on each of
+ * the 28 lines of four is kept up to date as pieces are added and
+ * removed, so a win can be detected without scanning the board, and so
+ * is the position's Zobrist key, the line and square part of its
+ * evaluation (see eval.h) and the squares where each player would
+ * complete a line.
+ */
+
+
+#ifndef POSITION_H_
+#define POSITION_H_
+
+#include <stdint.h>
+#include "display.h"
+#include "lines.h"
+#include "zobrist.h"
+
+#define SQUARE(x, y) ((y) * WIDTH + (x))
+#define SQUARE_X(square) ((square) % WIDTH)
+#define SQUARE_Y(square) ((square) / WIDTH)
+#define SQUARE_MASK(square) ((uint32_t)1 << (square))
+#define NO_SQUARE 63
+
+#define BOARD_MASK 0x01FFFFFFUL
+
+// returns the other player
+#define OPPONENT(player) (PLAYER_1 + PLAYER_2 - (player))
+
+typedef struct {
+	// occupancy of the board, indexed by player - 1
+	uint32_t pieces[2];
+	// number of pieces each player has on each line, and the number of
+	// lines each player has filled
+	uint8_t line_counts[2][NUM_LINES];
+	uint8_t lines_completed[2];
+	uint8_t num_pieces[2];
+	// bit n of threat_lines is set if the player has 3 pieces on line n
+	// and the fourth square is empty, and threats holds those fourth
+	// squares: a piece there would win
+	uint32_t threat_lines[2];
+	uint32_t threats[2];
+	// the player whose turn it is
+	uint8_t player;
+	// the square the player to move has picked a piece up from part way
+	// through a move, or NO_SQUARE
+	uint8_t lifted;
+	// Zobrist key of the pieces, player to move and lifted square
+	ZobristKey key;
+	// line and square score from player 1's point of view
+	int16_t score;
+} Position;
+
+// empties the board and gives the first turn to player 1
+void position_clear(Position *position);
+
+// returns EMPTY_SQUARE, PLAYER_1 or PLAYER_2
+uint8_t position_piece_at(const Position *position, uint8_t square);
+
+// returns the mask of squares occupied by either player
+uint32_t position_occupied(const Position *position);
+
+// add or remove a piece for the given player, keeping the line counts
+// up to date. These do not change whose turn it is.
+void position_add_piece(Position *position, uint8_t player, uint8_t square);
+void position_remove_piece(Position *position, uint8_t player, uint8_t square);
+
+// passes the turn to the other player
+void position_toggle_player(Position *position);
+
+// the first half of a phase 2 move: picks up the piece belonging to the
+// player to move at square
+void position_lift(Position *position, uint8_t square);
+
+// places a piece for the player to move at square (either a phase 1 drop
+// or the second half of a phase 2 move) and passes the turn on
+void position_drop(Position *position, uint8_t square);
+
+// calculates the Zobrist key of the position from scratch. position->key
+// always holds this value, it is kept up to date as the position changes.
+ZobristKey position_compute_key(const Position *position);
+
+// returns 1 if either player has four pieces in a line
+uint8_t position_is_won(const Position *position);
+
+// returns the length of the longest run of pieces the player has in any
+// direction
+uint8_t position_longest_run(const Position *position, uint8_t player);
+
+
+#endif /* POSITION_H_ */
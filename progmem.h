@@ -0,0 +1,43 @@
+/*
+ * progmem.h
+ *
+ * Author: Eve
+ *
+ * Lookup tables used by the game rules, and the strings printed to the
+ * terminal, are stored in flash with PROGMEM and PSTR on the AVR. The
+ * same code is also built for the host (for analysis tools and the host
+ * build of the game), where there is no separate program memory, so
+ * there the table reads are plain memory reads.
+ *
+ * The computer players keep their search state in variables marked
+ * THREAD_LOCAL, which on the host gives each thread its own copy so that
+ * tools can play several games at once.
+ */
+
+
+#ifndef PROGMEM_H_
+#define PROGMEM_H_
+
+#ifdef __AVR__
+
+#include <avr/pgmspace.h>
+
+#define THREAD_LOCAL
+
+#else
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define PROGMEM
+#define THREAD_LOCAL __thread
+#define PSTR(string) (string)
+#define printf_P printf
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+#define pgm_read_dword(address) (*(const uint32_t *)(address))
+
+#endif /* __AVR__ */
+
+
+#endif /* PROGMEM_H_ */
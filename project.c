@@ -9,21 +9,25 @@
 
 #include <stdio.h>
 #include <stdint.h>
-#include <avr/io.h>
-#include <avr/interrupt.h>
-#include <avr/pgmspace.h>
-
-#define F_CPU 8000000L
-#include <util/delay.h>
 
+#include "ai.h"
 #include "game.h"
+#include "hal.h"
+#include "mcts.h"
 #include "display.h"
 #include "ledmatrix.h"
 #include "buttons.h"
+#include "progmem.h"
 #include "serialio.h"
 #include "terminalio.h"
 #include "timer0.h"
 
+/* The valid move LED is on pin D3, the seven segment display's
+** segments on port A and its digit select on pin C0.
+*/
+#define VALID_MOVE_LED (1 << 3)
+#define SEVEN_SEG_CC (1 << 0)
+
 // Function prototypes - these are defined below (after main()) in the order
 // given here
 void initialise_hardware(void);
@@ -31,6 +35,16 @@ void start_screen(void);
 void new_game(void);
 void play_game(void);
 void handle_game_over(void);
+void seven_seg_refresh(void);
+void print_computer_player(void);
+void computer_search_start(void);
+uint8_t computer_search_step(void);
+void computer_ponder_step(void);
+void start_hint(void);
+void hint_step(void);
+
+/* The game being played, shown on the LED matrix */
+GameState game;
 
 /* digits_displayed - 1 if digits are displayed on the seven
 ** segment display, 0 if not. No digits displayed initially.
@@ -45,6 +59,42 @@ volatile uint8_t longest_line_1 = 0;
 
 volatile uint8_t longest_line_2 = 0;
 
+/* The player the computer is playing for, or 0 when both players are
+** human. Toggled with 'c' and kept from one game to the next.
+*/
+uint8_t computer_player = 0;
+
+/* 1 if the computer plays with Monte Carlo tree search rather than
+** alpha-beta search. Toggled with 'm'.
+*/
+uint8_t use_mcts = 0;
+
+/* 1 while the computer is part way through choosing a move, and the
+** time it started thinking.
+*/
+uint8_t computer_thinking = 0;
+uint32_t computer_think_start;
+
+/* 1 while the computer is thinking during the human's turn, and the time
+** it started.
+*/
+uint8_t pondering = 0;
+uint32_t ponder_start;
+
+/* Buttons 0 and 3 pushed together ask for a hint */
+#define HINT_CHORD ((1 << BUTTON0_PUSHED) | (1 << BUTTON3_PUSHED))
+
+/* How long the hint keeps being refined after it is first shown */
+#define HINT_REFINE_TIME 3000
+
+/* 1 while the search is refining the hint shown on the LED matrix, the
+** time the hint was asked for, the position it is for and the move shown.
+*/
+uint8_t hint_active = 0;
+uint32_t hint_start;
+ZobristKey hint_key;
+Move hint_move;
+
 /* Seven segment display segment values for 0 to 4 */
 uint8_t seven_seg_data[10] = {63,6,91,79,102};
 
@@ -74,28 +124,19 @@ void initialise_hardware(void) {
 	init_serial_stdio(19200,0);
 	
 	init_timer0();
-	DDRD |= (1<<DDRD3);
+	hal_gpio_set_outputs(HAL_PORT_D, VALID_MOVE_LED);
 	
-	DDRA = 0xFF;
-	DDRC = 0x01;
+	hal_gpio_set_outputs(HAL_PORT_A, 0xFF);
+	hal_gpio_set_outputs(HAL_PORT_C, SEVEN_SEG_CC);
 
 	/* Set up timer/counter 1 so that we get an 
 	** interrupt 100 times per second, i.e. every
 	** 10 milliseconds.
 	*/
-	OCR1A = 9999; /* Clock divided by 8 - count for 10000 cycles */
-	TCCR1A = 0; /* CTC mode */
-	TCCR1B = (1<<WGM12)|(1<<CS11); /* Divide clock by 8 */
-
-	/* Enable interrupt on timer on output compare match 
-	*/
-	TIMSK1 = (1<<OCIE1A);
-
-	/* Ensure interrupt flag is cleared */
-	TIFR1 = (1<<OCF1A);
+	hal_timer_start(HAL_TIMER_1, 10, seven_seg_refresh);
 	
 	// Turn on global interrupts
-	sei();
+	hal_interrupts_enable();
 }
 
 void start_screen(void) {
@@ -137,7 +178,8 @@ void new_game(void) {
 	clear_terminal();
 	
 	// Initialise the game and display
-	initialise_game();
+	initialise_game(&game, 1);
+	ai_new_game();
 	
 	// Clear a button push or serial input if any are waiting
 	// (The cast to void means the return value is ignored.)
@@ -151,31 +193,45 @@ void play_game(void) {
 	uint8_t btn; //the button pushed
 	char serial_input;
 	uint8_t cursor_x, cursor_y;
+	uint8_t hint_requested;
 	
 	last_flash_time = get_current_time();
-	print_current_player_display();
-	PORTD |= (1 << PORTD3);
+	print_current_player_display(get_player(&game));
+	print_computer_player();
+	computer_thinking = 0;
+	pondering = 0;
+	hint_active = 0;
+	hal_gpio_set(HAL_PORT_D, VALID_MOVE_LED);
 	
 	// We play the game until it's over
-	while(!is_game_over()) {
+	while(!is_game_over(&game)) {
 				
 		// We need to check if any button has been pushed, this will be
 		// NO_BUTTON_PUSHED if no button has been pushed
 		btn = button_pushed();
 		serial_input = -1;
-		cursor_x = get_cursor_x();
-		cursor_y = get_cursor_y();
+		hint_requested = 0;
+		cursor_x = get_cursor_x(&game);
+		cursor_y = get_cursor_y(&game);
 
 		
 		if (serial_input_available()) {
 			serial_input = fgetc(stdin);
 		}
 		
-		if (valid_move(cursor_x, cursor_y)) {
-			PORTD |= (1 << PORTD3);
+		// A push completing the hint chord asks for a hint instead of
+		// moving the cursor
+		if (btn != (uint8_t)NO_BUTTON_PUSHED
+				&& (buttons_held() & HINT_CHORD) == HINT_CHORD) {
+			btn = NO_BUTTON_PUSHED;
+			hint_requested = 1;
+		}
+		
+		if (valid_move(&game, cursor_x, cursor_y)) {
+			hal_gpio_set(HAL_PORT_D, VALID_MOVE_LED);
 		}
 		else {
-			PORTD = 0x00;
+			hal_gpio_write(HAL_PORT_D, 0x00);
 		}
 		
 		
@@ -204,12 +260,12 @@ void play_game(void) {
 			// If button 3 is pushed, move left,
 			// i.e decrease x by 1 and leave y the same
 			if (cursor_x != 0) {
-				move_display_cursor(-1, 0);
+				move_display_cursor(&game, -1, 0);
 				//flash?
 				last_flash_time = get_current_time();
 			}
 			else {
-				move_display_cursor(4,0);
+				move_display_cursor(&game, 4,0);
 			}
 			
 		}
@@ -217,14 +273,14 @@ void play_game(void) {
 		if (btn == BUTTON2_PUSHED || serial_input == 'd' || serial_input == 'D') {
 			// If button 2 is pushed, move right,
 			// i.e increase x by 1 and leave y the same
-			move_display_cursor(1, 0);
+			move_display_cursor(&game, 1, 0);
 			last_flash_time = get_current_time();
 		}
 		
 		if (btn == BUTTON1_PUSHED || serial_input == 'w' || serial_input == 'W') {
 			// If button 1 is pushed, move up,
 			// i.e increase y by 1 and leave x the same
-			move_display_cursor(0, 1);
+			move_display_cursor(&game, 0, 1);
 			last_flash_time = get_current_time();
 		}
 			
@@ -232,18 +288,72 @@ void play_game(void) {
 			// If button 0 is pushed, move down,
 			// i.e decrease y by 1 and leave x the same
 			if (cursor_y != 0) {
-				move_display_cursor(0, -1);
+				move_display_cursor(&game, 0, -1);
 				last_flash_time = get_current_time();
 			}
 			else {
-				move_display_cursor(0, 4);
+				move_display_cursor(&game, 0, 4);
 			}
 			
 		}
 		
-		if (serial_input == ' ') {
-			piece_placement();
-			print_current_player_display();
+		if (serial_input == 'C' || serial_input == 'c') {
+			// Hand player 2 to the computer, or back to a human
+			if (computer_player) {
+				computer_player = 0;
+			} else {
+				computer_player = PLAYER_2;
+			}
+			print_computer_player();
+		}
+		
+		if (serial_input == 'M' || serial_input == 'm') {
+			// Switch between the computer's two search methods
+			use_mcts = 1 - use_mcts;
+			computer_thinking = 0;
+			pondering = 0;
+			print_computer_player();
+		}
+		
+		if (hint_requested || serial_input == 'H' || serial_input == 'h') {
+			start_hint();
+		}
+		hint_step();
+		
+		// The computer's pieces can't be moved from here, unless one
+		// was picked up before the computer took over
+		if (serial_input == ' ' && (get_player(&game) != computer_player
+				|| get_game_position(&game)->lifted != NO_SQUARE)) {
+			piece_placement(&game);
+			print_current_player_display(get_player(&game));
+		}
+		
+		if (get_player(&game) == computer_player && !is_game_over(&game)
+				&& get_game_position(&game)->lifted == NO_SQUARE) {
+			// The search runs a slice at a time, so the cursor keeps
+			// flashing and the inputs are still read while it thinks
+			if (!computer_thinking) {
+				computer_search_start();
+			}
+			if (computer_search_step()) {
+				if (use_mcts) {
+					play_move(&game, mcts_best_move());
+				} else {
+					play_move(&game, ai_best_move());
+				}
+				computer_thinking = 0;
+				print_current_player_display(get_player(&game));
+			}
+		} else if (computer_player && !is_game_over(&game)) {
+			// It's the human's turn, the computer uses the time to
+			// think about its reply
+			computer_thinking = 0;
+			if (!hint_active) {
+				computer_ponder_step();
+			}
+		} else {
+			computer_thinking = 0;
+			pondering = 0;
 		}
 
 	
@@ -251,7 +361,7 @@ void play_game(void) {
 		if(current_time >= last_flash_time + 500) {
 			// 500ms (0.5 second) has passed since the last time we
 			// flashed the cursor, so flash the cursor
-			flash_cursor();
+			flash_cursor(&game);
 			
 			// Update the most recent time the cursor was flashed
 			last_flash_time = current_time;
@@ -260,6 +370,136 @@ void play_game(void) {
 	// We get here if the game is over.
 }
 
+void print_computer_player(void) {
+	move_terminal_cursor(10, 12);
+	if (computer_player) {
+		printf_P(PSTR("Computer: player %d (press c to stop)"), computer_player);
+	} else {
+		printf_P(PSTR("Computer: off (press c to play player 2)"));
+	}
+	clear_to_end_of_line();
+	move_terminal_cursor(10, 13);
+	if (use_mcts) {
+		printf_P(PSTR("Search: Monte Carlo (press m for alpha-beta)"));
+	} else {
+		printf_P(PSTR("Search: alpha-beta (press m for Monte Carlo)"));
+	}
+	clear_to_end_of_line();
+}
+
+void computer_search_start(void) {
+	const Position *position = get_game_position(&game);
+	uint8_t ponder_hit = 0;
+	
+	// A hint still being refined (if the computer has just taken over
+	// the player it was for) stops here, as the computer's search takes
+	// over the search memory
+	hint_active = 0;
+	// Carry on from the pondering if it was about this position, in which
+	// case the computer has been thinking since the pondering started
+	if (pondering) {
+		if (use_mcts) {
+			ponder_hit = mcts_search_advance(position);
+		} else {
+			ponder_hit = ai_ponder_hit(position);
+		}
+		pondering = 0;
+	}
+	if (ponder_hit) {
+		computer_think_start = ponder_start;
+	} else {
+		if (use_mcts) {
+			mcts_search_start(position);
+		} else {
+			ai_search_start(position);
+		}
+		computer_think_start = get_current_time();
+	}
+	computer_thinking = 1;
+}
+
+// runs one slice of the search during the human's turn, starting it when
+// the turn begins
+void computer_ponder_step(void) {
+	const Position *position = get_game_position(&game);
+	if (!pondering) {
+		// wait for a whole position if a piece has been picked up
+		if (position->lifted != NO_SQUARE) {
+			return;
+		}
+		if (use_mcts) {
+			mcts_search_start(position);
+		} else {
+			ai_ponder_start(position);
+		}
+		pondering = 1;
+		ponder_start = get_current_time();
+	}
+	if (use_mcts) {
+		mcts_search_step(MCTS_SLICE_PLAYOUTS);
+	} else {
+		ai_ponder_step(AI_SLICE_NODES);
+	}
+}
+
+// runs one slice of the computer's search, and returns 1 once it is time
+// for the computer to move
+uint8_t computer_search_step(void) {
+	uint8_t thinking_time_up = get_current_time() - computer_think_start >= AI_TIME_BUDGET;
+	if (use_mcts) {
+		return !mcts_search_step(MCTS_SLICE_PLAYOUTS) || thinking_time_up;
+	}
+	if (!ai_search_step(AI_SLICE_NODES)) {
+		return 1;
+	}
+	// always finish the one ply search
+	return thinking_time_up && ai_search_depth() > 0;
+}
+
+// shows the best move for the human player to move, from a one ply
+// search, then leaves the search running to refine it
+void start_hint(void) {
+	const Position *position = get_game_position(&game);
+	if (is_game_over(&game) || position->lifted != NO_SQUARE
+			|| get_player(&game) == computer_player) {
+		return;
+	}
+	// The hint borrows the search from the pondering, which starts again
+	// once the hint is finished
+	pondering = 0;
+	ai_search_start(position);
+	while (ai_search_step(AI_SLICE_NODES) && ai_search_depth() == 0) {
+		; // a one ply search is only a few dozen nodes
+	}
+	hint_move = ai_best_move();
+	show_hint(&game, hint_move);
+	hint_active = 1;
+	hint_start = get_current_time();
+	hint_key = position->key;
+}
+
+// runs one slice of the hint's search, updating the LED matrix if it
+// finds a better move
+void hint_step(void) {
+	if (!hint_active) {
+		return;
+	}
+	if (get_game_position(&game)->key != hint_key) {
+		// a move has been made, which clears the hint
+		hint_active = 0;
+		return;
+	}
+	if (!ai_search_step(AI_SLICE_NODES)
+			|| get_current_time() - hint_start >= HINT_REFINE_TIME) {
+		hint_active = 0;
+	}
+	Move move = ai_best_move();
+	if (move.from != hint_move.from || move.to != hint_move.to) {
+		hint_move = move;
+		show_hint(&game, hint_move);
+	}
+}
+
 void handle_game_over() {
 	clear_terminal();
 	move_terminal_cursor(10,14);
@@ -276,165 +516,37 @@ void handle_game_over() {
 	
 }
 
-ISR(TIMER1_COMPA_vect) {
-	uint8_t player = get_player();
+// runs every 10 milliseconds from timer 1
+void seven_seg_refresh(void) {
 	/* Change which digit will be displayed. If last time was
 	** left, now display right. If last time was right, now 
 	** display left.
 	*/
-	if (!is_game_over()) {
-		if (player == PLAYER_1) {
-			for (uint8_t i = 0; i < WIDTH; i++) {
-				for (uint8_t j = 0; j < HEIGHT; j++) {
-					int8_t direction_1 = 0;
-					int8_t direction_2 = 0;
-					int8_t direction_3 = 0;
-					int8_t direction_4 = 0;
-					if (get_piece_at(i, j) == PLAYER_1) {
-						direction_1 += 1; 
-						direction_2 += 1;
-						direction_3 += 1;
-						direction_4 += 1;
-						if (get_piece_at(i+1, j) == PLAYER_1) {
-							direction_1 += 1;
-							if (get_piece_at(i+2, j) == PLAYER_1) {
-								direction_1 += 1;
-								if (get_piece_at(i+3, j) == PLAYER_1) {
-									direction_1 += 1;
-								}
-							}
-						}
-						else if (get_piece_at(i, j+1) == PLAYER_1) {
-							direction_2 += 1;
-							if (get_piece_at(i, j+2) == PLAYER_1) {
-								direction_2 += 1;
-								if (get_piece_at(i, j+3) == PLAYER_1) {
-									direction_2 += 1;
-								}
-							}
-						} 
-						else if (get_piece_at(i+1, j+1) == PLAYER_1) {
-							direction_3 += 1;
-							if (get_piece_at(i+2, j+2) == PLAYER_1) {
-								direction_3 += 1;
-								if (get_piece_at(i+3, j+3) == PLAYER_1) {
-									direction_3 += 1;
-								}
-							}
-						} 
-						else if (get_piece_at(i-1, j) == PLAYER_1) {
-							direction_4 += 1;
-							if (get_piece_at(i-2, j) == PLAYER_1) {
-								direction_4 += 1;
-								if (get_piece_at(i-3, j) == PLAYER_1) {
-									direction_4 += 1;
-								}
-							}
-						}
-						
-						if (longest_line_1 < direction_1) {
-							longest_line_1 = direction_1;	
-						}
-						
-						if (longest_line_1 < direction_2) {
-							longest_line_1 = direction_2;
-						}
-						
-						if (longest_line_1 < direction_3) {
-							longest_line_1 = direction_3;
-						}
-						
-						if (longest_line_1 < direction_4) {
-							longest_line_1 = direction_4;
-						}
-					}
-				}
-			}
-		}
-			
-		if (player == PLAYER_2) {
-			for (uint8_t i = 0; i < WIDTH; i++) {
-				for (uint8_t j = 0; j < HEIGHT; j++) {
-					int8_t direction_1 = 0;
-					int8_t direction_2 = 0;
-					int8_t direction_3 = 0;
-					int8_t direction_4 = 0;
-					if (get_piece_at(i, j) == PLAYER_2) {
-						direction_1 += 1;
-						direction_2 += 1;
-						direction_3 += 1;
-						direction_4 += 1;
-						if (get_piece_at(i+1, j) == PLAYER_2) {
-							direction_1 += 1;
-							if (get_piece_at(i+2, j) == PLAYER_2) {
-								direction_1 += 1;
-								if (get_piece_at(i+3, j) == PLAYER_2) {
-									direction_1 += 1;
-								}
-							}
-						}
-						else if (get_piece_at(i, j+1) == PLAYER_2) {
-							direction_2 += 1;
-							if (get_piece_at(i, j+2) == PLAYER_2) {
-								direction_2 += 1;
-								if (get_piece_at(i, j+3) == PLAYER_2) {
-									direction_2 += 1;
-								}
-							}
-						} 
-						else if (get_piece_at(i+1, j+1) == PLAYER_2) {
-							direction_3 += 1;
-							if (get_piece_at(i+2, j+2) == PLAYER_2) {
-								direction_3 += 1;
-								if (get_piece_at(i+3, j+3) == PLAYER_2) {
-									direction_3 += 1;
-								}
-							}
-						} 
-						else if (get_piece_at(i-1, j) == PLAYER_2) {
-							direction_4 += 1;
-							if (get_piece_at(i-2, j) == PLAYER_2) {
-								direction_4 += 1;
-								if (get_piece_at(i-3, j) == PLAYER_2) {
-									direction_4 += 1;
-								}
-							}
-						}
-						if (longest_line_2 < direction_1) {
-							longest_line_2 = direction_1;
-						}
-							
-						if (longest_line_2 < direction_2) {
-							longest_line_2 = direction_2;
-						}
-							
-						if (longest_line_2 < direction_3) {
-							longest_line_2 = direction_3;
-						}
-							
-						if (longest_line_2 < direction_4) {
-							longest_line_2 = direction_4;
-						}
-					}
-				}
-			}				
-		}
+	if (!is_game_over(&game)) {
+		/* The longest lines are cached by the game as pieces move,
+		** so all we need to do here is read them.
+		*/
+		longest_line_1 = get_longest_line(&game, PLAYER_1);
+		longest_line_2 = get_longest_line(&game, PLAYER_2);
+		
 		seven_seg_cc = 1 ^ seven_seg_cc;
 		
 		if(digits_displayed) {
 			/* Display a digit */
 			if(seven_seg_cc == 0) {
 				/* Display rightmost digit - player 2 */
-				PORTA = seven_seg_data[longest_line_2];
+				hal_gpio_write(HAL_PORT_A, seven_seg_data[longest_line_2]);
 				} else {
 				/* Display leftmost digit - player 1 */
-				PORTA = seven_seg_data[longest_line_1];
+				hal_gpio_write(HAL_PORT_A, seven_seg_data[longest_line_1]);
 			}
 			/* Output the digit selection (CC) bit */
-			PORTC = seven_seg_cc;
+			hal_gpio_write(HAL_PORT_C, seven_seg_cc);
 			} else {
 			/* No digits displayed -  display is blank */
-			PORTA = 0;
+			hal_gpio_write(HAL_PORT_A, 0);
 		}
 	}
 }
+
+HAL_TIMER_1_HANDLER(seven_seg_refresh)
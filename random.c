@@ -0,0 +1,18 @@
+/*
+ * random.c
+ *
+ * The xorshift random number generator
+ *
+ * Author: Eve
+ */
+
+#include "random.h"
+
+uint32_t random_number(uint32_t *state) {
+	uint32_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
@@ -0,0 +1,25 @@
+/*
+ * random.h
+ *
+ * Author: Eve
+ *
+ * The xorshift random number generator shared by the Monte Carlo search
+ * and the tools. Each user keeps its own state, so that threads (and
+ * the streams of tools/hostutil.h) don't disturb one another.
+ */
+
+
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include <stdint.h>
+
+// the state a generator starts from unless it's given a seed
+#define RANDOM_SEED 2463534242UL
+
+// the next number from the generator whose state is given, which must
+// never be 0
+uint32_t random_number(uint32_t *state);
+
+
+#endif /* RANDOM_H_ */
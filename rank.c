@@ -0,0 +1,194 @@
+/*
+ * rank.c
+ *
+ * Ranking and unranking of Teeko positions
+ *
+ * Author: Eve
+ */
+
+#include "rank.h"
+#include "progmem.h"
+
+// binomial_table[n][k] is n choose k
+static const uint16_t binomial_table[NUM_SQUARES + 1][5] PROGMEM = {
+	{1, 0, 0, 0, 0},
+	{1, 1, 0, 0, 0},
+	{1, 2, 1, 0, 0},
+	{1, 3, 3, 1, 0},
+	{1, 4, 6, 4, 1},
+	{1, 5, 10, 10, 5},
+	{1, 6, 15, 20, 15},
+	{1, 7, 21, 35, 35},
+	{1, 8, 28, 56, 70},
+	{1, 9, 36, 84, 126},
+	{1, 10, 45, 120, 210},
+	{1, 11, 55, 165, 330},
+	{1, 12, 66, 220, 495},
+	{1, 13, 78, 286, 715},
+	{1, 14, 91, 364, 1001},
+	{1, 15, 105, 455, 1365},
+	{1, 16, 120, 560, 1820},
+	{1, 17, 136, 680, 2380},
+	{1, 18, 153, 816, 3060},
+	{1, 19, 171, 969, 3876},
+	{1, 20, 190, 1140, 4845},
+	{1, 21, 210, 1330, 5985},
+	{1, 22, 231, 1540, 7315},
+	{1, 23, 253, 1771, 8855},
+	{1, 24, 276, 2024, 10626},
+	{1, 25, 300, 2300, 12650},
+};
+
+// piece counts and player to move for each class, in order of rank
+static const uint8_t class_pieces_1[NUM_RANK_CLASSES] PROGMEM = {
+	0, 1, 1, 2, 2, 3, 3, 4, 4, 4
+};
+static const uint8_t class_pieces_2[NUM_RANK_CLASSES] PROGMEM = {
+	0, 0, 1, 1, 2, 2, 3, 3, 4, 4
+};
+static const uint8_t class_players[NUM_RANK_CLASSES] PROGMEM = {
+	PLAYER_1, PLAYER_2, PLAYER_1, PLAYER_2, PLAYER_1,
+	PLAYER_2, PLAYER_1, PLAYER_2, PLAYER_1, PLAYER_2
+};
+static const uint32_t class_offsets[NUM_RANK_CLASSES + 1] PROGMEM = {
+	0UL, 1UL, 26UL, 626UL, 7526UL, 83426UL, 614726UL, 4156726UL,
+	FIRST_PHASE_2_RANK, 96691476UL, NUM_POSITION_RANKS
+};
+
+uint16_t binomial(uint8_t n, uint8_t k) {
+	return pgm_read_word(&binomial_table[n][k]);
+}
+
+uint8_t rank_class(uint8_t pieces_1, uint8_t pieces_2, uint8_t player) {
+	if (pieces_1 > 4 || pieces_2 > 4) {
+		return NUM_RANK_CLASSES;
+	}
+	if (pieces_1 == 4 && pieces_2 == 4) {
+		return (player == PLAYER_1) ? 8 : 9;
+	}
+	// in phase 1 player 1 has either the same number of pieces as player 2
+	// (and it is their turn) or one more (and it is player 2's turn)
+	if (pieces_1 == pieces_2 && player == PLAYER_1) {
+		return 2 * pieces_1;
+	}
+	if (pieces_1 == pieces_2 + 1 && player == PLAYER_2) {
+		return 2 * pieces_2 + 1;
+	}
+	return NUM_RANK_CLASSES;
+}
+
+uint32_t rank_class_offset(uint8_t class_number) {
+	return pgm_read_dword(&class_offsets[class_number]);
+}
+
+uint32_t rank_class_size(uint8_t class_number) {
+	return pgm_read_dword(&class_offsets[class_number + 1])
+			- pgm_read_dword(&class_offsets[class_number]);
+}
+
+uint8_t rank_class_pieces(uint8_t class_number, uint8_t player) {
+	if (player == PLAYER_1) {
+		return pgm_read_byte(&class_pieces_1[class_number]);
+	}
+	return pgm_read_byte(&class_pieces_2[class_number]);
+}
+
+uint8_t rank_class_player(uint8_t class_number) {
+	return pgm_read_byte(&class_players[class_number]);
+}
+
+uint8_t rank_class_of(uint32_t rank) {
+	uint8_t class_number = 0;
+	while (rank >= rank_class_offset(class_number + 1)) {
+		class_number++;
+	}
+	return class_number;
+}
+
+// returns the rank of a set of squares among all sets of the same size,
+// where each square is first renumbered to skip the squares in skip
+static uint16_t rank_combination(uint32_t mask, uint32_t skip) {
+	uint16_t rank = 0;
+	uint8_t k = 1;
+	while (mask) {
+		uint8_t square = __builtin_ctzl(mask);
+		uint8_t index = square - __builtin_popcountl(skip & (SQUARE_MASK(square) - 1));
+		mask &= mask - 1;
+		rank += binomial(index, k);
+		k++;
+	}
+	return rank;
+}
+
+// the reverse of rank_combination, returns the set of k squares with the
+// given rank
+static uint32_t unrank_combination(uint16_t rank, uint8_t k, uint32_t skip) {
+	uint32_t mask = 0;
+	uint8_t index = NUM_SQUARES;
+	for (; k > 0; k--) {
+		// find the largest index with binomial(index, k) <= rank
+		do {
+			index--;
+		} while (binomial(index, k) > rank);
+		rank -= binomial(index, k);
+		// convert the index back into a square by stepping over the
+		// skipped squares
+		uint8_t square = 0;
+		uint8_t count = 0;
+		for (;; square++) {
+			if (!(skip & SQUARE_MASK(square))) {
+				if (count == index) {
+					break;
+				}
+				count++;
+			}
+		}
+		mask |= SQUARE_MASK(square);
+	}
+	return mask;
+}
+
+uint32_t rank_masks(uint32_t pieces_1, uint32_t pieces_2, uint8_t player) {
+	uint8_t count_1 = __builtin_popcountl(pieces_1);
+	uint8_t count_2 = __builtin_popcountl(pieces_2);
+	uint8_t class_number = rank_class(count_1, count_2, player);
+	if (class_number == NUM_RANK_CLASSES) {
+		return NUM_POSITION_RANKS;
+	}
+	uint16_t choices_2 = binomial(NUM_SQUARES - count_1, count_2);
+	return rank_class_offset(class_number)
+			+ (uint32_t)rank_combination(pieces_1, 0) * choices_2
+			+ rank_combination(pieces_2, pieces_1);
+}
+
+void unrank_masks(uint32_t rank, uint32_t *pieces_1, uint32_t *pieces_2, uint8_t *player) {
+	uint8_t class_number = rank_class_of(rank);
+	uint8_t count_1 = rank_class_pieces(class_number, PLAYER_1);
+	uint8_t count_2 = rank_class_pieces(class_number, PLAYER_2);
+	uint16_t choices_2 = binomial(NUM_SQUARES - count_1, count_2);
+	rank -= rank_class_offset(class_number);
+	*pieces_1 = unrank_combination(rank / choices_2, count_1, 0);
+	*pieces_2 = unrank_combination(rank % choices_2, count_2, *pieces_1);
+	*player = rank_class_player(class_number);
+}
+
+uint32_t rank_position(const Position *position) {
+	return rank_masks(position->pieces[0], position->pieces[1], position->player);
+}
+
+void unrank_position(uint32_t rank, Position *position) {
+	uint32_t pieces[2];
+	uint8_t player;
+	unrank_masks(rank, &pieces[0], &pieces[1], &player);
+	position_clear(position);
+	for (uint8_t square = 0; square < NUM_SQUARES; square++) {
+		if (pieces[0] & SQUARE_MASK(square)) {
+			position_add_piece(position, PLAYER_1, square);
+		} else if (pieces[1] & SQUARE_MASK(square)) {
+			position_add_piece(position, PLAYER_2, square);
+		}
+	}
+	if (player != position->player) {
+		position_toggle_player(position);
+	}
+}
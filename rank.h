@@ -0,0 +1,64 @@
+/*
+ * rank.h
+ *
+ * Author: Eve
+ *
+ * Perfect hashing of Teeko positions. Every legal position without a
+ * lifted piece is given a unique rank between 0 and NUM_POSITION_RANKS-1,
+ * and the rank can be turned back into the position, so results for
+ * every position can be stored in a flat array indexed by rank.
+ *
+ * Positions are grouped into classes by how many pieces each player has
+ * and whose turn it is. Player 1 moves first, so in phase 1 the piece
+ * counts decide whose turn it is; only with all 8 pieces placed can it be
+ * either player's turn. Within a class, player 1's pieces are ranked as a
+ * combination of the 25 squares and player 2's as a combination of the 21
+ * to 25 squares player 1 does not occupy, using the combinatorial number
+ * system.
+ */
+
+
+#ifndef RANK_H_
+#define RANK_H_
+
+#include <stdint.h>
+#include "position.h"
+
+#define NUM_RANK_CLASSES 10
+#define NUM_POSITION_RANKS 172401726UL
+
+// the first rank of the phase 2 classes (4 pieces each)
+#define FIRST_PHASE_2_RANK 20981226UL
+
+// returns the number of ways of choosing k of n things, for n <= 25 and
+// k <= 4
+uint16_t binomial(uint8_t n, uint8_t k);
+
+// returns the class of positions with these piece counts and player to
+// move, or NUM_RANK_CLASSES if no legal position has them
+uint8_t rank_class(uint8_t pieces_1, uint8_t pieces_2, uint8_t player);
+
+// details of a class: the first rank in it, the number of positions in it,
+// and the piece counts and player to move of the positions in it
+uint32_t rank_class_offset(uint8_t class_number);
+uint32_t rank_class_size(uint8_t class_number);
+uint8_t rank_class_pieces(uint8_t class_number, uint8_t player);
+uint8_t rank_class_player(uint8_t class_number);
+
+// returns the class containing rank
+uint8_t rank_class_of(uint32_t rank);
+
+// rank and unrank positions given as bitboards for each player and the
+// player to move. The two bitboards must not share a square (player 2's
+// pieces are ranked among the squares player 1 leaves free, so an overlap
+// gives the rank of some other position). rank_masks returns
+// NUM_POSITION_RANKS if the piece counts aren't legal (see rank_class).
+uint32_t rank_masks(uint32_t pieces_1, uint32_t pieces_2, uint8_t player);
+void unrank_masks(uint32_t rank, uint32_t *pieces_1, uint32_t *pieces_2, uint8_t *player);
+
+// rank and unrank a Position. The position must not have a piece lifted.
+uint32_t rank_position(const Position *position);
+void unrank_position(uint32_t rank, Position *position);
+
+
+#endif /* RANK_H_ */
@@ -0,0 +1,36 @@
+/*
+ * search_memory.h
+ *
+ * Author: Eve
+ *
+ * The game only ever runs one of its two searches at a time, so on the
+ * AVR the bulk of their working memory shares one block of SRAM: the
+ * alpha-beta search's frames, move list and position (ai.c), and the
+ * Monte Carlo search's tree and root position (mcts.c). Each lays its own
+ * struct over the block. Starting either search takes the block over, so
+ * the other must be started again before it is stepped or asked for its
+ * best move. What a search keeps from one move to the next, like the
+ * transposition table, has memory of its own.
+ *
+ * On the host each search has its own memory for each thread.
+ */
+
+
+#ifndef SEARCH_MEMORY_H_
+#define SEARCH_MEMORY_H_
+
+#include <stdint.h>
+
+#ifdef __AVR__
+
+// enough for either search (each checks it has room when it is built):
+// 32 tree nodes of 11 bytes and a 92 byte position
+#define SEARCH_MEMORY_SIZE 444
+
+// defined in ai.c
+extern uint8_t search_memory[SEARCH_MEMORY_SIZE];
+
+#endif /* __AVR__ */
+
+
+#endif /* SEARCH_MEMORY_H_ */
@@ -18,16 +18,20 @@
  * The function input_available() can be used to test whether there is
  * input available to read from stdin.
  *
+ * Modified by Eve to reach the UART through the hardware abstraction
+ * layer (hal.h). On the host the stream is made with fopencookie()
+ * rather than avr-libc's FDEV_SETUP_STREAM.
+ *
  */
 
+#ifndef __AVR__
+#define _GNU_SOURCE
+#endif
+
 #include "serialio.h"
 #include <stdio.h>
 #include <stdint.h>
-#include <avr/io.h>
-#include <avr/interrupt.h>
-
-/* System clock rate in Hz. (L at the end indicates this is a long constant) */
-#define SYSCLK 8000000L
+#include "hal.h"
 
 /* Global variables */
 /* Circular buffer to hold outgoing characters. The insert_pos variable
@@ -65,15 +69,33 @@ static int8_t do_echo;
 void init_serial_stdio(long baudrate, int8_t echo);
 static int uart_put_char(char, FILE*);
 static int uart_get_char(FILE*);
+static void uart_received(char c);
+static void uart_transmit_ready(void);
 
 /* Setup a stream that uses the uart get and put functions. We will
  * make standard input and output use this stream below.
  */
+#ifdef __AVR__
 static FILE myStream = FDEV_SETUP_STREAM(uart_put_char, uart_get_char,
 		_FDEV_SETUP_RW);
+#else
+static ssize_t stream_write(void *cookie, const char *buffer, size_t size) {
+	for (size_t i = 0; i < size; i++) {
+		uart_put_char(buffer[i], 0);
+	}
+	return size;
+}
+
+static ssize_t stream_read(void *cookie, char *buffer, size_t size) {
+	if (size == 0) {
+		return 0;
+	}
+	buffer[0] = uart_get_char(0);
+	return 1;
+}
+#endif
 
 void init_serial_stdio(long baudrate, int8_t echo) {
-	uint16_t ubrr;
 	/*
 	 * Initialise our buffers
 	*/
@@ -88,34 +110,30 @@ void init_serial_stdio(long baudrate, int8_t echo) {
 	*/
 	do_echo = echo;
 	
-	/* Configure the serial port baud rate */
-	/* (This differs from the datasheet formula so that we get 
-	 * rounding to the nearest integer while using integer division
-	 * (which truncates)).
-	*/
-	ubrr = ((SYSCLK / (8 * baudrate)) + 1)/2 - 1;
-	UBRR0 = ubrr;
-	
 	/*
-	 * Enable transmission and receiving via UART. We don't enable
+	 * Configure the baud rate and enable transmission and receiving
+	 * via UART, with the receive complete interrupt. We don't enable
 	 * the UDR empty interrupt here (we wait until we've got a
 	 * character to transmit).
 	 * NOTE: Interrupts must be enabled globally for this
 	 * library to work, but we do not do this here.
 	*/
-	UCSR0B = (1<<RXEN0)|(1<<TXEN0);
-	
-	/*
-	 * Enable receive complete interrupt 
-	*/
-	UCSR0B  |= (1 <<RXCIE0);
+	hal_uart_init(baudrate, uart_received, uart_transmit_ready);
 
 	/* Set up our stream so the put and get functions below are used 
 	 * to write/read characters via the serial port when we use
 	 * stdio functions
 	*/
+#ifdef __AVR__
 	stdout = &myStream;
 	stdin = &myStream;
+#else
+	cookie_io_functions_t functions = {stream_read, stream_write, 0, 0};
+	FILE *stream = fopencookie(0, "r+", functions);
+	setvbuf(stream, 0, _IONBF, 0);
+	stdout = stream;
+	stdin = stream;
+#endif
 }
 
 int8_t serial_input_available(void) {
@@ -147,7 +165,7 @@ static int uart_put_char(char c, FILE* stream) {
 	 * enough space. The bytes_in_buffer variable will get modified by the
 	 * ISR which extracts bytes from the buffer.
 	*/
-	interrupts_enabled = bit_is_set(SREG, SREG_I);
+	interrupts_enabled = hal_interrupts_enabled();
 	while(bytes_in_out_buffer >= OUTPUT_BUFFER_SIZE) {
 		if(!interrupts_enabled) {
 			return 1;
@@ -164,7 +182,7 @@ static int uart_put_char(char c, FILE* stream) {
 	 * We reenable them if they were enabled when we entered the
 	 * function.
 	*/	
-	cli();
+	hal_interrupts_disable();
 	out_buffer[out_insert_pos++] = c;
 	bytes_in_out_buffer++;
 	if(out_insert_pos == OUTPUT_BUFFER_SIZE) {
@@ -174,9 +192,9 @@ static int uart_put_char(char c, FILE* stream) {
 	/* Reenable interrupts (UDR Empty interrupt may have been
 	 * disabled) - we ensure it is now enabled so that it will
 	 * fire and deal with the next character in the buffer. */
-	UCSR0B |= (1 << UDRIE0);
+	hal_uart_transmit_interrupt(1);
 	if(interrupts_enabled) {
-		sei();
+		hal_interrupts_enable();
 	}
 	return 0;
 }
@@ -194,8 +212,8 @@ int uart_get_char(FILE* stream) {
 	 * characters before the insert position (taking into account
 	 * that we may need to wrap around).
 	 */
-	uint8_t interrupts_enabled = bit_is_set(SREG, SREG_I);
-	cli();
+	uint8_t interrupts_enabled = hal_interrupts_enabled();
+	hal_interrupts_disable();
 	char c;
 	if(input_insert_pos - bytes_in_input_buffer < 0) {
 		/* Need to wrap around */
@@ -208,7 +226,7 @@ int uart_get_char(FILE* stream) {
 	/* Decrement our count of bytes in the input buffer */
 	bytes_in_input_buffer--;
 	if(interrupts_enabled) {
-		sei();
+		hal_interrupts_enable();
 	}	
 	return c;
 }
@@ -217,7 +235,7 @@ int uart_get_char(FILE* stream) {
  * Define the interrupt handler for UART Data Register Empty (i.e. 
  * another character can be taken from our buffer and written out)
  */
-ISR(USART0_UDRE_vect) 
+static void uart_transmit_ready(void)
 {
 	/* Check if we have data in our buffer */
 	if(bytes_in_out_buffer > 0) {
@@ -241,7 +259,7 @@ ISR(USART0_UDRE_vect)
 		bytes_in_out_buffer--;
 		
 		/* Output the character via the UART */
-		UDR0 = c;
+		hal_uart_send(c);
 	} else {
 		/* No data in the buffer. We disable the UART Data
 		 * Register Empty interrupt because otherwise it 
@@ -249,7 +267,7 @@ ISR(USART0_UDRE_vect)
 		 * The interrupt is reenabled when a character is
 		 * placed in the buffer.
 		 */
-		UCSR0B &= ~(1<<UDRIE0);
+		hal_uart_transmit_interrupt(0);
 	}
 }
 
@@ -259,11 +277,10 @@ ISR(USART0_UDRE_vect)
  * the input buffer.
  */
 
-ISR(USART0_RX_vect) 
+static void uart_received(char c)
 {
-	/* Read the character - we ignore the possibility of overrun. */
-	char c;
-	c = UDR0;
+	/* The character has been read - we ignore the possibility of
+	 * overrun. */
 		
 	if(do_echo && bytes_in_out_buffer < OUTPUT_BUFFER_SIZE) {
 		/* If echoing is enabled and there is output buffer
@@ -301,3 +318,6 @@ ISR(USART0_RX_vect)
 		}
 	}
 }
+
+HAL_UART_RECEIVED_HANDLER(uart_received)
+HAL_UART_TRANSMIT_READY_HANDLER(uart_transmit_ready)
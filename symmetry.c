@@ -0,0 +1,138 @@
+/*
+ * symmetry.c
+ *
+ * The 8 symmetries of the Teeko board
+ *
+ * Author: Eve
+ */
+
+#include "symmetry.h"
+#include "progmem.h"
+
+// the square each square is moved to by each transform
+static const uint8_t transform_squares[NUM_TRANSFORMS][NUM_SQUARES] PROGMEM = {
+	// identity
+	{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24},
+	// reflect left to right
+	{4, 3, 2, 1, 0, 9, 8, 7, 6, 5, 14, 13, 12, 11, 10, 19, 18, 17, 16, 15, 24, 23, 22, 21, 20},
+	// reflect top to bottom
+	{20, 21, 22, 23, 24, 15, 16, 17, 18, 19, 10, 11, 12, 13, 14, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4},
+	// rotate 180 degrees
+	{24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0},
+	// reflect in the diagonal through (0,0)
+	{0, 5, 10, 15, 20, 1, 6, 11, 16, 21, 2, 7, 12, 17, 22, 3, 8, 13, 18, 23, 4, 9, 14, 19, 24},
+	// rotate 90 degrees clockwise
+	{20, 15, 10, 5, 0, 21, 16, 11, 6, 1, 22, 17, 12, 7, 2, 23, 18, 13, 8, 3, 24, 19, 14, 9, 4},
+	// rotate 90 degrees anticlockwise
+	{4, 9, 14, 19, 24, 3, 8, 13, 18, 23, 2, 7, 12, 17, 22, 1, 6, 11, 16, 21, 0, 5, 10, 15, 20},
+	// reflect in the diagonal through (4,0)
+	{24, 19, 14, 9, 4, 23, 18, 13, 8, 3, 22, 17, 12, 7, 2, 21, 16, 11, 6, 1, 20, 15, 10, 5, 0},
+};
+
+// the transform which undoes each transform (only the two rotations by 90
+// degrees are not their own inverse)
+static const uint8_t inverse_transforms[NUM_TRANSFORMS] PROGMEM = {
+	0, 1, 2, 3, 4, 6, 5, 7
+};
+
+uint8_t transform_square(uint8_t transform, uint8_t square) {
+	return pgm_read_byte(&transform_squares[transform][square]);
+}
+
+uint8_t inverse_transform(uint8_t transform) {
+	return pgm_read_byte(&inverse_transforms[transform]);
+}
+
+uint32_t transform_mask(uint8_t transform, uint32_t mask) {
+	uint32_t result = 0;
+	while (mask) {
+		uint8_t square = __builtin_ctzl(mask);
+		mask &= mask - 1;
+		result |= SQUARE_MASK(transform_square(transform, square));
+	}
+	return result;
+}
+
+void transform_position(const Position *position, uint8_t transform, Position *result) {
+	position_clear(result);
+	for (uint8_t player = PLAYER_1; player <= PLAYER_2; player++) {
+		uint32_t pieces = position->pieces[player - 1];
+		while (pieces) {
+			uint8_t square = __builtin_ctzl(pieces);
+			pieces &= pieces - 1;
+			position_add_piece(result, player, transform_square(transform, square));
+		}
+	}
+	if (position->player != result->player) {
+		position_toggle_player(result);
+	}
+	if (position->lifted != NO_SQUARE) {
+		result->lifted = transform_square(transform, position->lifted);
+		result->key ^= zobrist_lifted_key(result->lifted);
+	}
+}
+
+// returns the key position would have after being transformed. Only the
+// pieces and lifted square move, so the key for whose turn it is can be
+// left out when comparing keys of the same position.
+static ZobristKey transformed_key(const Position *position, uint8_t transform) {
+	ZobristKey key = 0;
+	for (uint8_t player = PLAYER_1; player <= PLAYER_2; player++) {
+		uint32_t pieces = position->pieces[player - 1];
+		while (pieces) {
+			uint8_t square = __builtin_ctzl(pieces);
+			pieces &= pieces - 1;
+			key ^= zobrist_piece_key(player, transform_square(transform, square));
+		}
+	}
+	if (position->lifted != NO_SQUARE) {
+		key ^= zobrist_lifted_key(transform_square(transform, position->lifted));
+	}
+	return key;
+}
+
+uint8_t canonicalise(const Position *position, Position *canonical) {
+	uint8_t best = 0;
+	ZobristKey best_key = transformed_key(position, 0);
+	for (uint8_t transform = 1; transform < NUM_TRANSFORMS; transform++) {
+		ZobristKey key = transformed_key(position, transform);
+		if (key < best_key) {
+			best = transform;
+			best_key = key;
+		} else if (key == best_key) {
+			// either the two transforms give the same position, or the
+			// keys have collided. Break the tie on the pieces themselves
+			// so the same canonical position is always chosen.
+			uint32_t a1 = transform_mask(transform, position->pieces[0]);
+			uint32_t b1 = transform_mask(best, position->pieces[0]);
+			uint32_t a2 = transform_mask(transform, position->pieces[1]);
+			uint32_t b2 = transform_mask(best, position->pieces[1]);
+			if (a1 < b1 || (a1 == b1 && a2 < b2)) {
+				best = transform;
+			}
+		}
+	}
+	transform_position(position, best, canonical);
+	return best;
+}
+
+uint8_t canonicalise_masks(uint32_t *pieces_1, uint32_t *pieces_2) {
+	uint8_t best = IDENTITY_TRANSFORM;
+	uint32_t best_1 = *pieces_1;
+	uint32_t best_2 = *pieces_2;
+	for (uint8_t transform = 1; transform < NUM_TRANSFORMS; transform++) {
+		uint32_t moved_1 = transform_mask(transform, *pieces_1);
+		if (moved_1 > best_1) {
+			continue;
+		}
+		uint32_t moved_2 = transform_mask(transform, *pieces_2);
+		if (moved_1 < best_1 || moved_2 < best_2) {
+			best = transform;
+			best_1 = moved_1;
+			best_2 = moved_2;
+		}
+	}
+	*pieces_1 = best_1;
+	*pieces_2 = best_2;
+	return best;
+}
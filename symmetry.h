@@ -0,0 +1,55 @@
+/*
+ * symmetry.h
+ *
+ * Author: Eve
+ *
+ * The Teeko board has the 8 symmetries of a square: the identity, three
+ * rotations and four reflections. Positions related by a symmetry have
+ * the same game value, so caches and tables only need to store one of
+ * them - the canonical position, which is the symmetric position with the
+ * smallest Zobrist key.
+ *
+ * Transform t reflects left to right if bit 0 is set, then top to bottom
+ * if bit 1 is set, then swaps x and y if bit 2 is set.
+ */
+
+
+#ifndef SYMMETRY_H_
+#define SYMMETRY_H_
+
+#include <stdint.h>
+#include "position.h"
+
+#define NUM_TRANSFORMS 8
+#define IDENTITY_TRANSFORM 0
+
+// returns the square that square is moved to by transform
+uint8_t transform_square(uint8_t transform, uint8_t square);
+
+// returns the transform which undoes the given transform
+uint8_t inverse_transform(uint8_t transform);
+
+// returns the mask with every square moved by transform
+uint32_t transform_mask(uint8_t transform, uint32_t mask);
+
+// sets result to position with every piece moved by transform. The line
+// counts and key of result are rebuilt to match. result must not be the
+// same position as position.
+void transform_position(const Position *position, uint8_t transform, Position *result);
+
+// sets canonical to the symmetric position with the smallest key and
+// returns the transform which turns position into it. Applying
+// inverse_transform() of the result to squares in canonical gives the
+// matching squares in position.
+uint8_t canonicalise(const Position *position, Position *canonical);
+
+// moves the bitboards of a position without a lifted piece to their
+// canonical form, the symmetric position whose player 1 bitboard is
+// smallest (then whose player 2 bitboard is smallest), and returns the
+// transform used. Unlike canonicalise() this does not depend on the size
+// of the Zobrist keys, so it gives the same answer on every build and is
+// used for files shared between machines.
+uint8_t canonicalise_masks(uint32_t *pieces_1, uint32_t *pieces_2);
+
+
+#endif /* SYMMETRY_H_ */
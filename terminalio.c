@@ -6,10 +6,9 @@
  */
 
 #include "terminalio.h"
-#include "game.h"
 #include <stdio.h>
 #include <stdint.h>
-#include <avr/pgmspace.h>
+#include "progmem.h"
 
 
 void move_terminal_cursor(int x, int y) {
@@ -28,8 +27,7 @@ void clear_terminal(void) {
 	printf_P(PSTR("\x1b[2J"));
 }
 
-void print_current_player_display(void) {
-	uint8_t current_player = get_player();
+void print_current_player_display(uint8_t current_player) {
 	move_terminal_cursor(10, 10);
 	if (current_player == 1) {
 		printf_P(PSTR("Current player: 1, (green)"));
@@ -59,7 +59,7 @@ void move_terminal_cursor(int x, int y);
 void normal_display_mode(void);
 void reverse_video(void);
 void clear_terminal(void);
-void print_current_player_display(void);
+void print_current_player_display(uint8_t current_player);
 void clear_to_end_of_line(void);
 void set_display_attribute(DisplayParameter parameter);
 void hide_cursor(void);
@@ -6,23 +6,24 @@
  * We setup timer0 to generate an interrupt every 1ms
  * We update a global clock tick variable - whose value
  * can be retrieved using the get_clock_ticks() function.
+ *
+ * Modified by Eve to set the timer up through the hardware abstraction
+ * layer (hal.h).
  */
 
 #include "timer0.h"
-#include <avr/io.h>
-#include <avr/interrupt.h>
+#include "hal.h"
 
 /* Our internal clock tick count - incremented every 
  * millisecond. Will overflow every ~49 days. */
 static volatile uint32_t clockTicks;
 
+static inline __attribute__((always_inline)) void timer0_tick(void);
+
 /* Set up timer 0 to generate an interrupt every 1ms. 
- * We will divide the clock by 64 and count up to 124.
- * We will therefore get an interrupt every 64 x 125
- * clock cycles, i.e. every 1 milliseconds with an 8MHz
- * clock. 
- * The counter will be reset to 0 when it reaches it's
- * output compare value.
+ * On the AVR the clock is divided by 64 and counts up to 124,
+ * giving an interrupt every 64 x 125 clock cycles, i.e. every
+ * 1 milliseconds with an 8MHz clock. 
  */
 void init_timer0(void) {
 	/* Reset clock tick count. L indicates a long (32 bit) 
@@ -30,29 +31,10 @@ void init_timer0(void) {
 	 */
 	clockTicks = 0L;
 	
-	/* Clear the timer */
-	TCNT0 = 0;
-
-	/* Set the output compare value to be 124 */
-	OCR0A = 124;
-	
-	/* Set the timer to clear on compare match (CTC mode)
-	 * and to divide the clock by 64. This starts the timer
-	 * running.
+	/* Start the timer. Note that interrupts have to be enabled
+	 * globally before the interrupts will fire.
 	 */
-	TCCR0A = (1<<WGM01);
-	TCCR0B = (1<<CS01)|(1<<CS00);
-
-	/* Enable an interrupt on output compare match. 
-	 * Note that interrupts have to be enabled globally
-	 * before the interrupts will fire.
-	 */
-	TIMSK0 |= (1<<OCIE0A);
-	
-	/* Make sure the interrupt flag is cleared by writing a 
-	 * 1 to it.
-	 */
-	TIFR0 &= (1<<OCF0A);
+	hal_timer_start(HAL_TIMER_0, 1, timer0_tick);
 }
 
 uint32_t get_current_time(void) {
@@ -63,16 +45,21 @@ uint32_t get_current_time(void) {
 	 * of the value. Interrupts are re-enabled if they were
 	 * enabled at the start.
 	 */
-	uint8_t interruptsOn = bit_is_set(SREG, SREG_I);
-	cli();
+	uint8_t interruptsOn = hal_interrupts_enabled();
+	hal_interrupts_disable();
 	returnValue = clockTicks;
 	if(interruptsOn) {
-		sei();
+		hal_interrupts_enable();
 	}
 	return returnValue;
 }
 
-ISR(TIMER0_COMPA_vect) {
+/* Inlined into the timer 0 interrupt on the AVR, which then only has
+ * to save the registers the increment uses. Its address is taken for
+ * the host as well, so at -Os it has to be forced. */
+static inline __attribute__((always_inline)) void timer0_tick(void) {
 	/* Increment our clock tick count */
 	clockTicks++;
 }
+
+HAL_TIMER_0_HANDLER(timer0_tick)
@@ -0,0 +1,315 @@
+/*
+ * arena.c
+ *
+ * Plays two computer players against each other over many games, spread
+ * over threads, and reports how much stronger one is than the other.
+ *
+ * A player is given as ab:nodes (the alpha-beta search of ai.c, stopped
+ * after roughly that many nodes), mcts:playouts (the Monte Carlo search
+ * of mcts.c with that many playouts) or random. Budgets are counted
+ * rather than timed, so results don't depend on how busy the machine is.
+ *
+ * Games are played in pairs from the same opening of a few random moves,
+ * with the players swapping colours for the second game. A game is won
+ * by completing a line or leaving the other player no legal move (see
+ * position_is_lost), and drawn when a position comes up for the third
+ * time with the same player to move or when it reaches the move limit.
+ *
+ * The result is given as the first player's score, with the Elo
+ * difference it implies and its 95% confidence interval, and the
+ * likelihood of superiority (the chance the first player really is the
+ * stronger).
+ *
+ * Author: Eve
+ *
+ * Usage: arena [-g games] [-t threads] [-r random moves] [-m max moves]
+ *              [-s seed] player player
+ *
+ * Built for the host with make tools, as build/arena
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "ai.h"
+#include "mcts.h"
+#include "movegen.h"
+#include "hostutil.h"
+
+#define MAX_THREADS 256
+
+#define DEFAULT_GAMES 1000
+// games longer than this are called draws
+#define DEFAULT_MAX_PLIES 200
+// each pair of games starts with between 1 and this many random moves
+#define DEFAULT_RANDOM_PLIES 8
+#define MAX_RANDOM_PLIES 255
+#define MAX_GAME_PLIES 1000
+
+// a position seen this many times is a draw
+#define REPETITION_DRAW 3
+
+#define PLAYER_RANDOM 0
+#define PLAYER_AB 1
+#define PLAYER_MCTS 2
+
+typedef struct {
+	const char *name;
+	uint8_t type;
+	// nodes or playouts per move
+	uint32_t budget;
+} Player;
+
+// how a game ended, for the first player
+#define GAME_WIN 0
+#define GAME_DRAW 1
+#define GAME_LOSS 2
+
+// why it was drawn
+#define DRAW_REPETITION 0
+#define DRAW_MOVE_LIMIT 1
+
+static Player players[2];
+static uint32_t num_games = DEFAULT_GAMES;
+static uint16_t max_plies = DEFAULT_MAX_PLIES;
+static uint8_t max_random_plies = DEFAULT_RANDOM_PLIES;
+static uint32_t seed = RANDOM_SEED;
+
+static uint32_t next_game;
+static uint32_t results[3];
+static uint32_t draws[2];
+// games won by player 1 and by player 2 of the board, whichever of ours,
+// and those won by leaving the loser no legal move
+static uint32_t colour_wins[2];
+static uint32_t boxed_in_wins;
+static uint64_t total_plies;
+
+// the search of the last alpha-beta player to move on this thread, whose
+// transposition table would otherwise help the other player
+static __thread const Player *table_owner;
+
+static uint8_t parse_player(const char *text, Player *player) {
+	player->name = text;
+	player->budget = 0;
+	if (strcmp(text, "random") == 0) {
+		player->type = PLAYER_RANDOM;
+		return 1;
+	}
+	if (strncmp(text, "ab:", 3) == 0) {
+		player->type = PLAYER_AB;
+		player->budget = atol(text + 3);
+	} else if (strncmp(text, "mcts:", 5) == 0) {
+		player->type = PLAYER_MCTS;
+		player->budget = atol(text + 5);
+	}
+	return player->budget > 0;
+}
+
+static Move choose_move(const Player *player, const Position *position,
+		const MoveList *list, uint32_t *random_state) {
+	if (player->type == PLAYER_AB) {
+		if (table_owner != player) {
+			ai_new_game();
+			table_owner = player;
+		}
+		ai_search_start(position);
+		while (ai_search_step(256) && ai_search_nodes() < player->budget) {
+			;
+		}
+		return ai_best_move();
+	}
+	if (player->type == PLAYER_MCTS) {
+		return mcts_choose_move(position, 0, player->budget);
+	}
+	return list->moves[random_number(random_state) % list->count];
+}
+
+// plays the opening moves of a pair of games, returning 0 if one of them
+// happened to win
+static uint8_t play_opening(Position *position, uint32_t *random_state) {
+	MoveList list;
+	uint8_t plies = 1 + random_number(random_state) % max_random_plies;
+	position_clear(position);
+	for (uint8_t ply = 0; ply < plies; ply++) {
+		generate_moves(position, &list);
+		make_move(position, list.moves[random_number(random_state) % list.count]);
+		if (position_is_lost(position)) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+// the number of times the position has come up before in the game
+static uint16_t count_repeats(const Position *history, uint16_t plies, const Position *position) {
+	uint16_t repeats = 0;
+	for (uint16_t i = 0; i < plies; i++) {
+		if (history[i].key == position->key && history[i].player == position->player
+				&& history[i].pieces[0] == position->pieces[0]
+				&& history[i].pieces[1] == position->pieces[1]) {
+			repeats++;
+		}
+	}
+	return repeats;
+}
+
+// plays game number game and adds up its result
+static void play_game(uint32_t game) {
+	static __thread Position history[MAX_GAME_PLIES];
+	Position position;
+	MoveList list;
+	uint32_t random_state = random_stream(seed, game / 2);
+	// our first player takes player 1 in even games and player 2 in odd
+	const Player *by_colour[2] = {&players[game & 1], &players[!(game & 1)]};
+	uint16_t plies = 0;
+	uint8_t result = GAME_DRAW;
+	uint8_t draw = DRAW_MOVE_LIMIT;
+
+	while (!play_opening(&position, &random_state)) {
+		;
+	}
+	// from here the two games of the pair differ, so each has its own
+	// stream for the players
+	random_state = random_stream(seed, game | 0x80000000UL);
+	mcts_seed(random_number(&random_state));
+	table_owner = NULL;
+	while (1) {
+		if (position_is_lost(&position)) {
+			// the player who just moved completed a line or boxed in the
+			// player to move
+			uint8_t winner = OPPONENT(position.player);
+			__atomic_fetch_add(&colour_wins[winner - 1], 1, __ATOMIC_RELAXED);
+			if (!position_is_won(&position)) {
+				__atomic_fetch_add(&boxed_in_wins, 1, __ATOMIC_RELAXED);
+			}
+			result = by_colour[winner - 1] == &players[0] ? GAME_WIN : GAME_LOSS;
+			break;
+		}
+		if (count_repeats(history, plies, &position) >= REPETITION_DRAW - 1) {
+			draw = DRAW_REPETITION;
+			break;
+		}
+		if (plies == max_plies) {
+			break;
+		}
+		generate_moves(&position, &list);
+		history[plies++] = position;
+		Move move = choose_move(by_colour[position.player - 1], &position, &list, &random_state);
+		make_move(&position, move);
+	}
+	__atomic_fetch_add(&results[result], 1, __ATOMIC_RELAXED);
+	if (result == GAME_DRAW) {
+		__atomic_fetch_add(&draws[draw], 1, __ATOMIC_RELAXED);
+	}
+	__atomic_fetch_add(&total_plies, plies, __ATOMIC_RELAXED);
+}
+
+static void *worker_thread(void *arg) {
+	(void)arg;
+	while (1) {
+		uint32_t game = __atomic_fetch_add(&next_game, 1, __ATOMIC_RELAXED);
+		if (game >= num_games) {
+			break;
+		}
+		play_game(game);
+	}
+	return NULL;
+}
+
+// the Elo difference that gives an expected score
+static double elo(double score) {
+	if (score <= 0) {
+		return -INFINITY;
+	}
+	if (score >= 1) {
+		return INFINITY;
+	}
+	return -400 * log10(1 / score - 1);
+}
+
+static void print_results(double seconds, int num_threads) {
+	uint32_t wins = results[GAME_WIN];
+	uint32_t losses = results[GAME_LOSS];
+	uint32_t drawn = results[GAME_DRAW];
+	double score = (wins + 0.5 * drawn) / num_games;
+	// the standard error of the mean score per game
+	double variance = (wins * pow(1 - score, 2) + drawn * pow(0.5 - score, 2)
+			+ losses * pow(score, 2)) / num_games;
+	double error = sqrt(variance / num_games);
+	double los = 0.5;
+	if (wins + losses) {
+		los = 0.5 * (1 + erf(((double)wins - losses) / sqrt(2.0 * (wins + losses))));
+	}
+
+	printf("%s vs %s: %u games on %d threads (%.1fs, %.1f moves a game)\n",
+			players[0].name, players[1].name, num_games, num_threads, seconds,
+			(double)total_plies / num_games);
+	printf("%s: %u wins, %u draws, %u losses, score %.1f%%\n",
+			players[0].name, wins, drawn, losses, 100 * score);
+	printf("player 1 won %u, player 2 won %u, %u of them by leaving no legal move\n",
+			colour_wins[0], colour_wins[1], boxed_in_wins);
+	printf("draws: %u by repetition, %u by move limit\n",
+			draws[DRAW_REPETITION], draws[DRAW_MOVE_LIMIT]);
+	printf("Elo difference %+.1f (95%% confidence %+.1f to %+.1f), LOS %.1f%%\n",
+			elo(score), elo(score - 1.96 * error), elo(score + 1.96 * error), 100 * los);
+}
+
+int main(int argc, char *argv[]) {
+	int num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	// parsed at full width, so out of range values are caught rather
+	// than wrapped
+	int random_plies = DEFAULT_RANDOM_PLIES;
+	int plies = DEFAULT_MAX_PLIES;
+	pthread_t threads[MAX_THREADS];
+	int option;
+
+	while ((option = getopt(argc, argv, "g:t:r:m:s:")) != -1) {
+		if (option == 'g') {
+			num_games = atol(optarg);
+		} else if (option == 't') {
+			num_threads = atoi(optarg);
+		} else if (option == 'r') {
+			random_plies = atoi(optarg);
+		} else if (option == 'm') {
+			plies = atoi(optarg);
+		} else if (option == 's') {
+			seed = strtoul(optarg, NULL, 0);
+		} else {
+			break;
+		}
+	}
+	if (option != -1 || optind + 2 != argc || !parse_player(argv[optind], &players[0])
+			|| !parse_player(argv[optind + 1], &players[1])) {
+		fprintf(stderr, "usage: %s [-g games] [-t threads] [-r random moves] [-m max moves] "
+				"[-s seed] player player\n"
+				"a player is ab:nodes, mcts:playouts or random\n", argv[0]);
+		return 1;
+	}
+	if (num_games < 1 || random_plies < 1 || random_plies > MAX_RANDOM_PLIES
+			|| plies < 1 || plies > MAX_GAME_PLIES) {
+		fprintf(stderr, "need at least one game, 1 to %u random moves and 1 to %u moves a game\n",
+				MAX_RANDOM_PLIES, MAX_GAME_PLIES);
+		return 1;
+	}
+	max_random_plies = random_plies;
+	max_plies = plies;
+	if (num_threads < 1) {
+		num_threads = 1;
+	} else if (num_threads > MAX_THREADS) {
+		num_threads = MAX_THREADS;
+	}
+
+	double start = now_seconds();
+	for (int i = 0; i < num_threads; i++) {
+		pthread_create(&threads[i], NULL, worker_thread, NULL);
+	}
+	for (int i = 0; i < num_threads; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	print_results(now_seconds() - start, num_threads);
+	return 0;
+}
@@ -0,0 +1,186 @@
+/*
+ * batchwin.c
+ *
+ * Bit sliced line checks over batches of positions
+ *
+ * Author: Eve
+ */
+
+#include <string.h>
+#include <pthread.h>
+#include "batchwin.h"
+#include "lines.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_X86 1
+#endif
+
+// player 2's squares are kept 32 bits above player 1's in each position's
+// word, so after the transpose their squares are words 32 on
+#define PLAYER_2_WORDS 32
+
+typedef void (*FindWins)(const uint32_t *pieces_1, const uint32_t *pieces_2, uint16_t count,
+		uint64_t *won_1, uint64_t *won_2);
+
+typedef struct {
+	const char *name;
+	FindWins find_wins;
+	// positions checked by each call to find_wins
+	uint16_t positions;
+} Backend;
+
+// the four squares of each line
+static uint8_t line_squares[NUM_LINES][4];
+
+static const Backend *backend;
+static pthread_once_t backend_once = PTHREAD_ONCE_INIT;
+
+// words of 64 bits, and vectors of 2 and 4 of them
+typedef uint64_t Lanes1;
+typedef uint64_t Lanes2 __attribute__((vector_size(16)));
+typedef uint64_t Lanes4 __attribute__((vector_size(32)));
+
+// one step of transposing the 64x64 bit matrix in words: swaps the
+// blocks of j bits above the diagonal with those below it
+#define TRANSPOSE_STEP(Vector, j, mask) \
+	for (uint8_t k = 0; k < 64; k = (k + (j) + 1) & ~(j)) { \
+		Vector t = ((words[k] >> (j)) ^ words[k + (j)]) & (mask); \
+		words[k] ^= t << (j); \
+		words[k + (j)] ^= t; \
+	}
+
+// the body of each implementation, for a vector type of one 64-bit lane
+// per block of 64 positions. Lane k of words[r] starts as position
+// 64k + r and is transposed so that lane k of words[s] holds square s of
+// every position in the block, one bit per position.
+#define FIND_WINS_BODY(Vector, blocks) \
+	uint64_t lanes[64][blocks]; \
+	Vector words[64]; \
+	Vector won[2] = {0, 0}; \
+	if (count < 64 * (blocks)) { \
+		memset(lanes, 0, sizeof(lanes)); \
+	} \
+	for (uint8_t k = 0; k < (blocks); k++) { \
+		for (uint8_t r = 0; r < 64 && 64 * k + r < count; r++) { \
+			uint16_t i = 64 * k + r; \
+			lanes[r][k] = pieces_1[i] | (uint64_t)pieces_2[i] << PLAYER_2_WORDS; \
+		} \
+	} \
+	memcpy(words, lanes, sizeof(words)); \
+	TRANSPOSE_STEP(Vector, 32, 0x00000000FFFFFFFFULL) \
+	TRANSPOSE_STEP(Vector, 16, 0x0000FFFF0000FFFFULL) \
+	TRANSPOSE_STEP(Vector, 8, 0x00FF00FF00FF00FFULL) \
+	TRANSPOSE_STEP(Vector, 4, 0x0F0F0F0F0F0F0F0FULL) \
+	TRANSPOSE_STEP(Vector, 2, 0x3333333333333333ULL) \
+	TRANSPOSE_STEP(Vector, 1, 0x5555555555555555ULL) \
+	for (uint8_t line = 0; line < NUM_LINES; line++) { \
+		const uint8_t *s = line_squares[line]; \
+		won[0] |= words[s[0]] & words[s[1]] & words[s[2]] & words[s[3]]; \
+		won[1] |= words[PLAYER_2_WORDS + s[0]] & words[PLAYER_2_WORDS + s[1]] \
+				& words[PLAYER_2_WORDS + s[2]] & words[PLAYER_2_WORDS + s[3]]; \
+	} \
+	memcpy(won_1, &won[0], sizeof(won[0])); \
+	memcpy(won_2, &won[1], sizeof(won[1]));
+
+static void find_wins_scalar(const uint32_t *pieces_1, const uint32_t *pieces_2, uint16_t count,
+		uint64_t *won_1, uint64_t *won_2) {
+	FIND_WINS_BODY(Lanes1, 1)
+}
+
+#ifdef HAVE_X86
+
+__attribute__((target("sse2")))
+static void find_wins_sse2(const uint32_t *pieces_1, const uint32_t *pieces_2, uint16_t count,
+		uint64_t *won_1, uint64_t *won_2) {
+	FIND_WINS_BODY(Lanes2, 2)
+}
+
+__attribute__((target("avx2")))
+static void find_wins_avx2(const uint32_t *pieces_1, const uint32_t *pieces_2, uint16_t count,
+		uint64_t *won_1, uint64_t *won_2) {
+	FIND_WINS_BODY(Lanes4, 4)
+}
+
+#endif /* HAVE_X86 */
+
+// best first
+static const Backend backends[] = {
+#ifdef HAVE_X86
+	{"avx2", find_wins_avx2, 256},
+	{"sse2", find_wins_sse2, 128},
+#endif
+	{"scalar", find_wins_scalar, 64},
+};
+
+#define NUM_BACKENDS (sizeof(backends) / sizeof(backends[0]))
+
+static uint8_t backend_supported(const Backend *candidate) {
+#ifdef HAVE_X86
+	__builtin_cpu_init();
+	if (candidate->find_wins == find_wins_avx2) {
+		return __builtin_cpu_supports("avx2") != 0;
+	}
+	if (candidate->find_wins == find_wins_sse2) {
+		return __builtin_cpu_supports("sse2") != 0;
+	}
+#endif
+	(void)candidate;
+	return 1;
+}
+
+static void find_line_squares(void) {
+	for (uint8_t line = 0; line < NUM_LINES; line++) {
+		uint32_t mask = get_line_mask(line);
+		for (uint8_t n = 0; n < 4; n++) {
+			line_squares[line][n] = __builtin_ctzl(mask);
+			mask &= mask - 1;
+		}
+	}
+}
+
+// picks the best implementation the processor can run
+static void choose_backend(void) {
+	find_line_squares();
+	for (uint8_t n = 0; n < NUM_BACKENDS; n++) {
+		if (backend_supported(&backends[n])) {
+			__atomic_store_n(&backend, &backends[n], __ATOMIC_RELEASE);
+			return;
+		}
+	}
+}
+
+static const Backend *current_backend(void) {
+	pthread_once(&backend_once, choose_backend);
+	return __atomic_load_n(&backend, __ATOMIC_ACQUIRE);
+}
+
+void batch_find_wins(const uint32_t *pieces_1, const uint32_t *pieces_2, uint16_t count,
+		uint64_t won_1[WIN_BATCH_WORDS], uint64_t won_2[WIN_BATCH_WORDS]) {
+	const Backend *current = current_backend();
+	uint16_t done = 0;
+	while (done < WIN_BATCH_SIZE) {
+		if (done < count) {
+			current->find_wins(pieces_1 + done, pieces_2 + done, count - done,
+					won_1 + done / 64, won_2 + done / 64);
+		} else {
+			memset(won_1 + done / 64, 0, current->positions / 8);
+			memset(won_2 + done / 64, 0, current->positions / 8);
+		}
+		done += current->positions;
+	}
+}
+
+const char *batch_win_backend(void) {
+	return current_backend()->name;
+}
+
+uint8_t batch_win_use(const char *name) {
+	current_backend();
+	for (uint8_t n = 0; n < NUM_BACKENDS; n++) {
+		if (strcmp(backends[n].name, name) == 0 && backend_supported(&backends[n])) {
+			__atomic_store_n(&backend, &backends[n], __ATOMIC_RELEASE);
+			return 1;
+		}
+	}
+	return 0;
+}
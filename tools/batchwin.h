@@ -0,0 +1,43 @@
+/*
+ * batchwin.h
+ *
+ * Author: Eve
+ *
+ * Checks a batch of up to 256 positions for completed lines at once, for
+ * the host tools that sweep through millions of positions given as
+ * bitboards (where there are no line counts to read, see
+ * has_four_in_line).
+ *
+ * The bitboards are bit sliced: each block of 64 positions is transposed
+ * so that one 64-bit word holds a square for all 64 of them, and then
+ * each line is four ANDs for the whole block. Blocks are processed 4 at
+ * a time with AVX2 or 2 at a time with SSE2, whichever the processor
+ * has (found when the first batch is checked), or one at a time with
+ * plain 64-bit words.
+ */
+
+
+#ifndef BATCHWIN_H_
+#define BATCHWIN_H_
+
+#include <stdint.h>
+
+#define WIN_BATCH_SIZE 256
+#define WIN_BATCH_WORDS (WIN_BATCH_SIZE / 64)
+
+// checks positions 0 to count - 1 (count at most WIN_BATCH_SIZE), where
+// player 1 has the pieces in pieces_1 and player 2 those in pieces_2. Bit
+// i % 64 of won_1[i / 64] is set if player 1 has four in a line in
+// position i, and likewise won_2 for player 2. Bits past count are 0.
+void batch_find_wins(const uint32_t *pieces_1, const uint32_t *pieces_2, uint16_t count,
+		uint64_t won_1[WIN_BATCH_WORDS], uint64_t won_2[WIN_BATCH_WORDS]);
+
+// the name of the implementation in use: "avx2", "sse2" or "scalar"
+const char *batch_win_backend(void);
+
+// uses the named implementation from now on, returning 0 (and changing
+// nothing) if there isn't one by that name or the processor can't run it
+uint8_t batch_win_use(const char *name);
+
+
+#endif /* BATCHWIN_H_ */
@@ -0,0 +1,320 @@
+/*
+ * bench.c
+ *
+ * Times the game functions the firmware runs from its main loop and its
+ * timer 1 interrupt, over a corpus of positions taken from random games:
+ * some in the drop phase, some in the move phase and some with a piece
+ * picked up, each with the cursor on a square where the player to move
+ * can act. The games are drawn on the LED matrix, so the time includes
+ * the SPI traffic.
+ *
+ * On the host each function is run over the corpus many times and the
+ * time per call is reported in nanoseconds, both as measured and less
+ * the cost of the timing loop, which is measured first. Built for the
+ * AVR it times every call on its own with timer 1 counting processor
+ * cycles (see hal.h), so that none takes long enough for the 16-bit
+ * count to wrap, and prints the mean and worst case less the timing
+ * overhead over the serial port at 19200 baud, with the timer 1
+ * handler's share of its 10ms slot.
+ *
+ * Author: Eve
+ *
+ * Usage: bench [-n repeats]
+ *
+ * Built for the host with make bench, and for the AVR with make bench-avr
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "game.h"
+#include "display.h"
+#include "hal.h"
+#include "ledmatrix.h"
+#include "progmem.h"
+#include "random.h"
+
+#ifdef __AVR__
+#include "serialio.h"
+#define CORPUS_SIZE 8
+#else
+#include <stdlib.h>
+#include <unistd.h>
+#include "hostutil.h"
+#define CORPUS_SIZE 1024
+#define DEFAULT_REPEATS 2000
+#endif
+
+// the number of plies of each random game, at most
+#define MAX_GAME_PLIES 40
+
+// processor cycles between timer 1 interrupts, at 8MHz
+#define TIMER1_SLOT_CYCLES 80000UL
+
+typedef struct {
+	const char *name;
+	// makes the nth of the case's calls
+	void (*run)(GameState *game, uint8_t n);
+	// the number of different calls, such as one for each square
+	uint8_t calls;
+	// 1 if run changes the game, so it must be given a copy
+	uint8_t changes_game;
+	// 1 if run is only timed on games with a piece picked up
+	uint8_t needs_lifted;
+} BenchCase;
+
+static GameState corpus[CORPUS_SIZE];
+// results are added in here so the calls can't be optimised away
+static volatile uint8_t sink;
+
+static uint32_t rng_state = RANDOM_SEED;
+
+// returns a random square from a non-empty mask
+static uint8_t random_square(uint32_t mask) {
+	uint8_t n = random_number(&rng_state) % __builtin_popcountl(mask);
+	while (n--) {
+		mask &= mask - 1;
+	}
+	return __builtin_ctzl(mask);
+}
+
+static void set_cursor(GameState *game, uint8_t square) {
+	game->cursor_x = SQUARE_X(square);
+	game->cursor_y = SQUARE_Y(square);
+}
+
+// plays a random game for a random number of plies, stopping short of a
+// win, and leaves the cursor where the player to move can act
+static void random_game(GameState *game) {
+	MoveList list;
+	uint8_t plies = random_number(&rng_state) % MAX_GAME_PLIES;
+	initialise_game(game, 0);
+	for (uint8_t ply = 0; ply < plies; ply++) {
+		if (generate_moves(&game->position, &list) == 0) {
+			break;
+		}
+		Position next = game->position;
+		Move move = list.moves[random_number(&rng_state) % list.count];
+		make_move(&next, move);
+		if (position_is_won(&next)) {
+			break;
+		}
+		play_move(game, move);
+	}
+	if (generate_moves(&game->position, &list) == 0) {
+		return;
+	}
+	Move move = list.moves[random_number(&rng_state) % list.count];
+	if (move.from != NO_SQUARE && (random_number(&rng_state) & 1)) {
+		// pick the piece up, then aim at one of the squares it can go to
+		set_cursor(game, move.from);
+		piece_placement(game);
+		set_cursor(game, random_square(game->validmove_mask));
+	} else if (move.from != NO_SQUARE) {
+		set_cursor(game, move.from);
+	} else {
+		set_cursor(game, move.to);
+	}
+	game->displayed = 1;
+}
+
+static void run_nothing(GameState *game, uint8_t n) {
+	(void)game;
+	(void)n;
+}
+
+static void run_is_game_over(GameState *game, uint8_t n) {
+	(void)n;
+	sink += is_game_over(game);
+}
+
+// for each square
+static void run_valid_move(GameState *game, uint8_t n) {
+	sink += valid_move(game, SQUARE_X(n), SQUARE_Y(n));
+}
+
+static void run_piece_placement(GameState *game, uint8_t n) {
+	(void)n;
+	piece_placement(game);
+}
+
+static void run_valid_move_leds(GameState *game, uint8_t n) {
+	(void)n;
+	valid_move_leds(game);
+}
+
+// for each player
+static void run_longest_run(GameState *game, uint8_t n) {
+	sink += position_longest_run(&game->position, PLAYER_1 + n);
+}
+
+// the work of the timer 1 handler in project.c, which shows the cached
+// longest lines on the seven segment display
+static void run_timer1(GameState *game, uint8_t n) {
+	(void)n;
+	if (!is_game_over(game)) {
+		hal_gpio_write(HAL_PORT_A, get_longest_line(game, PLAYER_1));
+		hal_gpio_write(HAL_PORT_A, get_longest_line(game, PLAYER_2));
+		hal_gpio_write(HAL_PORT_C, 1);
+	}
+}
+
+// for each square
+static void run_update_square_colour(GameState *game, uint8_t n) {
+	update_square_colour(SQUARE_X(n), SQUARE_Y(n), get_piece_at(game, SQUARE_X(n), SQUARE_Y(n)));
+}
+
+static const BenchCase cases[] = {
+	{"is_game_over", run_is_game_over, 1, 0, 0},
+	{"valid_move", run_valid_move, NUM_SQUARES, 0, 0},
+	{"piece_placement", run_piece_placement, 1, 1, 0},
+	{"valid_move_leds", run_valid_move_leds, 1, 0, 1},
+	{"longest line scan", run_longest_run, 2, 0, 0},
+	{"timer 1 handler", run_timer1, 1, 0, 0},
+	{"update_square_colour", run_update_square_colour, NUM_SQUARES, 0, 0},
+};
+
+#define NUM_CASES (sizeof(cases) / sizeof(cases[0]))
+
+static uint8_t skip_game(const BenchCase *bench, const GameState *game) {
+	return bench->needs_lifted && game->position.lifted == NO_SQUARE;
+}
+
+#ifdef __AVR__
+
+// the mean and worst number of cycles a call takes, each call timed on
+// its own
+static void time_case(const BenchCase *bench, uint16_t *mean, uint16_t *worst) {
+	GameState copy;
+	uint32_t total = 0;
+	uint16_t runs = 0;
+	*worst = 0;
+	for (uint16_t i = 0; i < CORPUS_SIZE; i++) {
+		if (skip_game(bench, &corpus[i])) {
+			continue;
+		}
+		for (uint8_t n = 0; n < bench->calls; n++) {
+			GameState *game = &corpus[i];
+			if (bench->changes_game) {
+				copy = *game;
+				game = &copy;
+			}
+			hal_interrupts_disable();
+			uint16_t start = hal_cycle_count();
+			bench->run(game, n);
+			uint16_t cycles = hal_cycle_count() - start;
+			hal_interrupts_enable();
+			total += cycles;
+			runs++;
+			if (cycles > *worst) {
+				*worst = cycles;
+			}
+		}
+	}
+	*mean = runs ? total / runs : 0;
+}
+
+static void run_benchmarks(void) {
+	static const BenchCase empty = {"", run_nothing, 1, 0, 0};
+	uint16_t overhead, mean, worst;
+	time_case(&empty, &overhead, &worst);
+	printf_P(PSTR("%-22s %8s %8s\n"), "cycles per call", "mean", "worst");
+	for (uint8_t n = 0; n < NUM_CASES; n++) {
+		const BenchCase *bench = &cases[n];
+		time_case(bench, &mean, &worst);
+		mean = mean > overhead ? mean - overhead : 0;
+		worst = worst > overhead ? worst - overhead : 0;
+		printf_P(PSTR("%-22s %8u %8u"), bench->name, mean, worst);
+		if (bench->run == run_timer1) {
+			printf_P(PSTR("  (%u.%02u%% of its slot)"),
+					(uint16_t)(worst * 100UL / TIMER1_SLOT_CYCLES),
+					(uint16_t)(worst * 10000UL / TIMER1_SLOT_CYCLES % 100));
+		}
+		printf_P(PSTR("\n"));
+	}
+}
+
+int main(void) {
+	init_serial_stdio(19200, 0);
+	ledmatrix_setup();
+	hal_cycle_counter_start();
+	hal_interrupts_enable();
+	for (uint16_t i = 0; i < CORPUS_SIZE; i++) {
+		random_game(&corpus[i]);
+	}
+	run_benchmarks();
+	while (1) {
+		; // the results stay on the terminal
+	}
+}
+
+#else
+
+static uint32_t repeats = DEFAULT_REPEATS;
+
+// the total time of every call of the case, and the number of calls
+static double time_case(const BenchCase *bench, uint64_t *calls) {
+	GameState copy;
+	double start = now_seconds();
+	*calls = 0;
+	for (uint32_t repeat = 0; repeat < repeats; repeat++) {
+		for (uint32_t i = 0; i < CORPUS_SIZE; i++) {
+			if (skip_game(bench, &corpus[i])) {
+				continue;
+			}
+			for (uint8_t n = 0; n < bench->calls; n++) {
+				GameState *game = &corpus[i];
+				if (bench->changes_game) {
+					copy = *game;
+					game = &copy;
+				}
+				bench->run(game, n);
+				(*calls)++;
+			}
+		}
+	}
+	return now_seconds() - start;
+}
+
+static void run_benchmarks(void) {
+	// the loop, with and without copying the game
+	static const BenchCase empty[2] = {
+		{"", run_nothing, 1, 0, 0},
+		{"", run_nothing, 1, 1, 0},
+	};
+	double overhead[2];
+	uint64_t calls;
+	for (uint8_t n = 0; n < 2; n++) {
+		overhead[n] = time_case(&empty[n], &calls) / calls;
+	}
+	printf("%u positions, %u repeats, timing loop %.1f ns/call (%.1f copying the game)\n",
+			CORPUS_SIZE, repeats, overhead[0] * 1e9, overhead[1] * 1e9);
+	// a call quicker than the noise in the loop's time can come out
+	// below 0 once the loop is taken off
+	printf("%-22s %10s %10s\n", "ns per call", "measured", "less loop");
+	for (uint8_t n = 0; n < NUM_CASES; n++) {
+		const BenchCase *bench = &cases[n];
+		double per_call = time_case(bench, &calls) / calls;
+		printf("%-22s %10.1f %10.1f\n", bench->name, per_call * 1e9,
+				(per_call - overhead[bench->changes_game]) * 1e9);
+	}
+}
+
+int main(int argc, char *argv[]) {
+	int option;
+	while ((option = getopt(argc, argv, "n:")) != -1) {
+		if (option == 'n' && atoi(optarg) > 0) {
+			repeats = atoi(optarg);
+		} else {
+			fprintf(stderr, "usage: %s [-n repeats]\n", argv[0]);
+			return 1;
+		}
+	}
+	ledmatrix_setup();
+	for (uint32_t i = 0; i < CORPUS_SIZE; i++) {
+		random_game(&corpus[i]);
+	}
+	run_benchmarks();
+	return 0;
+}
+
+#endif /* __AVR__ */
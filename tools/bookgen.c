@@ -0,0 +1,247 @@
+/*
+ * bookgen.c
+ *
+ * Generates the opening book (book_data.h) from the tablebase. For each
+ * side the computer could play, every drop phase position the computer
+ * can reach with the book's own replies against any human moves is
+ * stored, folded by the board symmetries, along with its best drop.
+ *
+ * The best drop wins fastest, or loses slowest, or among drawing drops
+ * leaves the opponent the most replies that lose.
+ *
+ * Author: Eve
+ *
+ * Usage: bookgen [-i tablebase] [-o header] [-n pieces]
+ *
+ * Only positions with fewer than the given number of pieces on the board
+ * are stored. The default of 6 covers the computer's first three drops
+ * in about 6KB of flash; the whole drop phase (8) would need over 60KB,
+ * more than the ATmega324A has.
+ *
+ * Built for the host from the top level directory with
+ *   gcc -O2 -I. -o bookgen tools/bookgen.c tools/tablebase.c lines.c \
+ *       position.c movegen.c rank.c symmetry.c zobrist.c eval.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "movegen.h"
+#include "rank.h"
+#include "symmetry.h"
+#include "solution.h"
+#include "tablebase.h"
+
+// open addressing set of the canonical ranks explored so far, sized well
+// beyond the number of positions in a full book
+#define VISITED_SIZE (1UL << 22)
+#define EMPTY_RANK 0xFFFFFFFFUL
+
+typedef struct {
+	uint32_t rank;
+	uint8_t square;
+} BookEntry;
+
+static Tablebase *tablebase;
+static uint32_t *visited;
+static BookEntry *entries;
+static uint32_t num_entries;
+static uint32_t max_entries;
+static uint8_t max_pieces = 6;
+
+// adds rank to the visited set, returning 0 if it was already there
+static int visit(uint32_t rank) {
+	uint32_t slot = (rank * 2654435761UL) & (VISITED_SIZE - 1);
+	while (visited[slot] != EMPTY_RANK) {
+		if (visited[slot] == rank) {
+			return 0;
+		}
+		slot = (slot + 1) & (VISITED_SIZE - 1);
+	}
+	visited[slot] = rank;
+	return 1;
+}
+
+static void add_entry(uint32_t rank, uint8_t square) {
+	if (num_entries == max_entries) {
+		max_entries = max_entries ? max_entries * 2 : 1024;
+		entries = realloc(entries, max_entries * sizeof(BookEntry));
+		if (!entries) {
+			fprintf(stderr, "out of memory\n");
+			exit(1);
+		}
+	}
+	entries[num_entries].rank = rank;
+	entries[num_entries].square = square;
+	num_entries++;
+}
+
+// looks up the position, which must not be won, for the player to move
+static void probe(const Position *position, uint8_t *result, uint8_t *distance) {
+	if (tablebase_probe(tablebase, position, result, distance)) {
+		fprintf(stderr, "could not look up a position\n");
+		exit(1);
+	}
+}
+
+// scores a move for the player making it, higher being better. position
+// is the position after the move.
+static int move_value(Position *position) {
+	uint8_t result, distance;
+	if (position_is_won(position)) {
+		return 3000;
+	}
+	probe(position, &result, &distance);
+	if (result == RESULT_LOSS) {
+		return 2000 - distance;
+	} else if (result == RESULT_WIN) {
+		return distance;
+	}
+	// a draw, count the opponent's replies that lose
+	MoveList list;
+	int traps = 0;
+	generate_moves(position, &list);
+	for (uint8_t i = 0; i < list.count; i++) {
+		make_move(position, list.moves[i]);
+		if (!position_is_won(position)) {
+			probe(position, &result, &distance);
+			traps += result == RESULT_WIN;
+		}
+		unmake_move(position, list.moves[i]);
+	}
+	return 1000 + traps;
+}
+
+// returns the canonical form of the position, which must not be won
+static void canonical_position(const Position *position, Position *canonical) {
+	uint32_t pieces_1 = position->pieces[0];
+	uint32_t pieces_2 = position->pieces[1];
+	canonicalise_masks(&pieces_1, &pieces_2);
+	unrank_position(rank_masks(pieces_1, pieces_2, position->player), canonical);
+}
+
+// explores the drop phase from a canonical position, booking a move for
+// every position where the computer (playing computer) is to move
+static void explore(Position *position, uint8_t computer) {
+	MoveList list;
+	uint8_t player = position->player;
+	uint8_t pieces = position->num_pieces[0] + position->num_pieces[1];
+
+	if (position_is_won(position) || position->num_pieces[computer - 1] == 4
+			|| pieces >= max_pieces || !visit(rank_position(position))) {
+		return;
+	}
+	generate_moves(position, &list);
+	if (player == computer) {
+		int best_value = -1;
+		Move best = list.moves[0];
+		for (uint8_t i = 0; i < list.count; i++) {
+			make_move(position, list.moves[i]);
+			int value = move_value(position);
+			unmake_move(position, list.moves[i]);
+			if (value > best_value) {
+				best_value = value;
+				best = list.moves[i];
+			}
+		}
+		add_entry(rank_position(position), best.to);
+		make_move(position, best);
+		if (!position_is_won(position)) {
+			Position canonical;
+			canonical_position(position, &canonical);
+			explore(&canonical, computer);
+		}
+		unmake_move(position, best);
+	} else {
+		for (uint8_t i = 0; i < list.count; i++) {
+			make_move(position, list.moves[i]);
+			if (!position_is_won(position)) {
+				Position canonical;
+				canonical_position(position, &canonical);
+				explore(&canonical, computer);
+			}
+			unmake_move(position, list.moves[i]);
+		}
+	}
+}
+
+static int compare_entries(const void *a, const void *b) {
+	uint32_t rank_a = ((const BookEntry *)a)->rank;
+	uint32_t rank_b = ((const BookEntry *)b)->rank;
+	return (rank_a > rank_b) - (rank_a < rank_b);
+}
+
+static int write_book(const char *filename) {
+	FILE *file = fopen(filename, "w");
+	if (!file) {
+		perror(filename);
+		return 1;
+	}
+	fprintf(file, "/*\n"
+			" * book_data.h\n"
+			" *\n"
+			" * Opening book generated by tools/bookgen from the tablebase, do not\n"
+			" * edit. Entries are sorted by the rank of the canonical position (see\n"
+			" * canonicalise_masks) and give the square to drop on in that\n"
+			" * orientation. Positions with up to %u pieces on the board are included.\n"
+			" */\n\n"
+			"#ifndef BOOK_DATA_H_\n"
+			"#define BOOK_DATA_H_\n\n"
+			"#define BOOK_ENTRIES %u\n\n"
+			"static const uint32_t book_ranks[BOOK_ENTRIES] PROGMEM = {\n",
+			max_pieces - 1, num_entries);
+	for (uint32_t i = 0; i < num_entries; i++) {
+		fprintf(file, "%s%luUL,%s", i % 6 ? " " : "\t", (unsigned long)entries[i].rank,
+				i % 6 == 5 || i == num_entries - 1 ? "\n" : "");
+	}
+	fprintf(file, "};\n\nstatic const uint8_t book_squares[BOOK_ENTRIES] PROGMEM = {\n");
+	for (uint32_t i = 0; i < num_entries; i++) {
+		fprintf(file, "%s%u,%s", i % 16 ? " " : "\t", entries[i].square,
+				i % 16 == 15 || i == num_entries - 1 ? "\n" : "");
+	}
+	fprintf(file, "};\n\n#endif /* BOOK_DATA_H_ */\n");
+	if (fclose(file)) {
+		perror(filename);
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	const char *input = "teeko.tb";
+	const char *output = "book_data.h";
+	int option;
+	while ((option = getopt(argc, argv, "i:o:n:")) != -1) {
+		if (option == 'i') {
+			input = optarg;
+		} else if (option == 'o') {
+			output = optarg;
+		} else if (option == 'n' && atoi(optarg) >= 1 && atoi(optarg) <= 8) {
+			max_pieces = atoi(optarg);
+		} else {
+			fprintf(stderr, "usage: %s [-i tablebase] [-o header] [-n pieces]\n", argv[0]);
+			return 1;
+		}
+	}
+	tablebase = tablebase_open(input);
+	visited = malloc(VISITED_SIZE * sizeof(uint32_t));
+	if (!tablebase || !visited) {
+		return 1;
+	}
+
+	// the positions where the computer moves as one player are those where
+	// the human moves as the other, so there is no overlap in the entries
+	for (uint8_t computer = PLAYER_1; computer <= PLAYER_2; computer++) {
+		Position position;
+		memset(visited, 0xFF, VISITED_SIZE * sizeof(uint32_t));
+		position_clear(&position);
+		explore(&position, computer);
+		printf("%u entries after booking player %u\n", num_entries, computer);
+	}
+	tablebase_close(tablebase);
+
+	qsort(entries, num_entries, sizeof(BookEntry), compare_entries);
+	return write_book(output);
+}
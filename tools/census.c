@@ -0,0 +1,244 @@
+/*
+ * census.c
+ *
+ * Counts every position that can come up in a game, by a breadth first
+ * search from the empty board, one layer (ply) at a time. Play stops at
+ * a won position, so a position only reachable by playing on after a win
+ * is not counted. Moves come from the move generator, which perft -g
+ * checks against the rules in game.c.
+ *
+ * Positions are kept as bitmaps over their ranks (see rank.h): the ones
+ * seen so far, the current layer and the next. Each layer is split into
+ * chunks of ranks that the threads take from a shared counter, and a
+ * thread claims a position for the next layer by setting its bit in the
+ * seen bitmap with an atomic OR, so each is only counted once.
+ *
+ * For each layer it reports the number of positions and how many of them
+ * are won, then totals for each phase, how many positions have each
+ * number of legal moves and how fast the search ran.
+ *
+ * Author: Eve
+ *
+ * Usage: census [-t threads] [-d max layers]
+ *
+ * Built for the host with make tools, as build/census
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "rank.h"
+#include "movegen.h"
+#include "hostutil.h"
+
+#define MAX_THREADS 256
+// 64-bit words of each bitmap handed to a thread at a time
+#define CHUNK_WORDS 4096
+#define BITMAP_WORDS ((NUM_POSITION_RANKS + 63) / 64)
+#define MAX_LAYERS 1000
+
+typedef struct {
+	uint64_t positions;
+	// positions where the player who just moved completed a line, and
+	// positions where the player to move has no legal move
+	uint64_t won;
+	uint64_t stuck;
+	// moves generated, and positions by how many legal moves they have
+	uint64_t moves;
+	uint64_t move_counts[MAX_MOVES + 1];
+} Counts;
+
+static uint64_t *seen;
+static uint64_t *layer;
+static uint64_t *next_layer;
+
+static int num_threads;
+static uint32_t next_word;
+static Counts layer_counts;
+static pthread_mutex_t counts_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void add_counts(Counts *total, const Counts *counts) {
+	total->positions += counts->positions;
+	total->won += counts->won;
+	total->stuck += counts->stuck;
+	total->moves += counts->moves;
+	for (uint8_t n = 0; n <= MAX_MOVES; n++) {
+		total->move_counts[n] += counts->move_counts[n];
+	}
+}
+
+// counts a position of the current layer, and adds the positions its
+// moves lead to that haven't been seen before to the next layer
+static void expand(uint32_t rank, Counts *counts) {
+	Position position;
+	MoveList list;
+	unrank_position(rank, &position);
+	counts->positions++;
+	if (position_is_won(&position)) {
+		counts->won++;
+		return;
+	}
+	generate_moves(&position, &list);
+	counts->moves += list.count;
+	counts->move_counts[list.count]++;
+	if (list.count == 0) {
+		counts->stuck++;
+	}
+	// the children are ranked from their bitboards, which is much cheaper
+	// than making each move on the position
+	uint8_t player = position.player;
+	for (uint8_t i = 0; i < list.count; i++) {
+		uint32_t pieces[2] = {position.pieces[0], position.pieces[1]};
+		if (list.moves[i].from != NO_SQUARE) {
+			pieces[player - 1] ^= SQUARE_MASK(list.moves[i].from);
+		}
+		pieces[player - 1] |= SQUARE_MASK(list.moves[i].to);
+		uint32_t child = rank_masks(pieces[0], pieces[1], OPPONENT(player));
+		uint64_t bit = (uint64_t)1 << (child % 64);
+		// most children have been seen already, and reading is cheaper
+		// than the atomic OR
+		if ((__atomic_load_n(&seen[child / 64], __ATOMIC_RELAXED) & bit) == 0
+				&& (__atomic_fetch_or(&seen[child / 64], bit, __ATOMIC_RELAXED) & bit) == 0) {
+			__atomic_fetch_or(&next_layer[child / 64], bit, __ATOMIC_RELAXED);
+		}
+	}
+}
+
+static void *worker_thread(void *arg) {
+	Counts counts;
+	(void)arg;
+	memset(&counts, 0, sizeof(counts));
+	while (1) {
+		uint32_t first = __atomic_fetch_add(&next_word, CHUNK_WORDS, __ATOMIC_RELAXED);
+		if (first >= BITMAP_WORDS) {
+			break;
+		}
+		uint32_t last = first + CHUNK_WORDS < BITMAP_WORDS ? first + CHUNK_WORDS : BITMAP_WORDS;
+		for (uint32_t word = first; word < last; word++) {
+			uint64_t bits = layer[word];
+			while (bits) {
+				expand(word * 64 + __builtin_ctzll(bits), &counts);
+				bits &= bits - 1;
+			}
+		}
+	}
+	pthread_mutex_lock(&counts_lock);
+	add_counts(&layer_counts, &counts);
+	pthread_mutex_unlock(&counts_lock);
+	return NULL;
+}
+
+// expands every position of the current layer over all the threads
+static void search_layer(void) {
+	pthread_t threads[MAX_THREADS];
+	next_word = 0;
+	memset(&layer_counts, 0, sizeof(layer_counts));
+	for (int i = 0; i < num_threads; i++) {
+		pthread_create(&threads[i], NULL, worker_thread, NULL);
+	}
+	for (int i = 0; i < num_threads; i++) {
+		pthread_join(threads[i], NULL);
+	}
+}
+
+// prints the totals over the layers searched, which are all of them
+// unless the search was stopped early
+static void print_summary(const Counts phases[2], uint16_t layers, uint8_t stopped, double seconds) {
+	Counts total;
+	memset(&total, 0, sizeof(total));
+	add_counts(&total, &phases[0]);
+	add_counts(&total, &phases[1]);
+	printf("\nphase   positions         won  no moves  moves/position\n");
+	for (uint8_t phase = 0; phase < 2; phase++) {
+		const Counts *counts = &phases[phase];
+		uint64_t expanded = counts->positions - counts->won;
+		printf("%5u  %10lu  %10lu  %8lu  %14.2f\n", phase + 1,
+				(unsigned long)counts->positions, (unsigned long)counts->won,
+				(unsigned long)counts->stuck, expanded ? (double)counts->moves / expanded : 0.0);
+	}
+	printf("%lu of %lu ranks reachable (%.1f%%), ", (unsigned long)total.positions,
+			NUM_POSITION_RANKS, 100.0 * total.positions / NUM_POSITION_RANKS);
+	if (stopped) {
+		printf("stopped after %u layers\n", layers);
+	} else {
+		printf("the deepest %u plies from the start\n", layers - 1);
+	}
+
+	printf("\nmoves   positions\n");
+	for (uint8_t n = 0; n <= MAX_MOVES; n++) {
+		if (total.move_counts[n]) {
+			printf("%5u  %10lu\n", n, (unsigned long)total.move_counts[n]);
+		}
+	}
+	printf("\n%.1fs, %.0f positions/s, %.0f moves/s\n", seconds,
+			total.positions / seconds, total.moves / seconds);
+}
+
+int main(int argc, char *argv[]) {
+	int max_layers = MAX_LAYERS;
+	int option;
+	double start;
+	Counts phases[2];
+	uint16_t layers = 0;
+
+	num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	while ((option = getopt(argc, argv, "t:d:")) != -1) {
+		if (option == 't') {
+			num_threads = atoi(optarg);
+		} else if (option == 'd' && atoi(optarg) > 0) {
+			max_layers = atoi(optarg);
+		} else {
+			fprintf(stderr, "usage: %s [-t threads] [-d max layers]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (num_threads < 1) {
+		num_threads = 1;
+	} else if (num_threads > MAX_THREADS) {
+		num_threads = MAX_THREADS;
+	}
+
+	seen = calloc(BITMAP_WORDS, sizeof(uint64_t));
+	layer = calloc(BITMAP_WORDS, sizeof(uint64_t));
+	next_layer = calloc(BITMAP_WORDS, sizeof(uint64_t));
+	if (!seen || !layer || !next_layer) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	memset(phases, 0, sizeof(phases));
+	start = now_seconds();
+
+	// the empty board, with player 1 to move
+	Position position;
+	position_clear(&position);
+	uint32_t rank = rank_position(&position);
+	seen[rank / 64] |= (uint64_t)1 << (rank % 64);
+	layer[rank / 64] |= (uint64_t)1 << (rank % 64);
+
+	printf("%d threads\nlayer  phase   positions         won  moves/position\n", num_threads);
+	while (layers < max_layers) {
+		search_layer();
+		if (layer_counts.positions == 0) {
+			break;
+		}
+		// every position with fewer than 8 pieces is the same number of
+		// plies from the start
+		uint8_t phase = layers < 8 ? 0 : 1;
+		uint64_t expanded = layer_counts.positions - layer_counts.won;
+		printf("%5u  %5u  %10lu  %10lu  %14.2f  (%.1fs)\n", layers, phase + 1,
+				(unsigned long)layer_counts.positions, (unsigned long)layer_counts.won,
+				expanded ? (double)layer_counts.moves / expanded : 0.0, now_seconds() - start);
+		fflush(stdout);
+		add_counts(&phases[phase], &layer_counts);
+		layers++;
+		uint64_t *expanded_layer = layer;
+		layer = next_layer;
+		next_layer = expanded_layer;
+		memset(next_layer, 0, BITMAP_WORDS * sizeof(uint64_t));
+	}
+	print_summary(phases, layers, layers == max_layers, now_seconds() - start);
+	return 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * check.c
+ *
+ * Regression checks for the rules and the computer players, for the
+ * cases the tools don't already cover by comparing against one another
+ * (perft -g, and tbgen's check of the tablebase against the solution).
+ * Each check prints what failed, and the program exits with 1 if any
+ * did.
+ *
+ * Positions are written as in perft: 25 squares of ., 1 or 2, row by row
+ * from (0,0) to (4,4), with a / between rows.
+ *
+ * Author: Eve
+ *
+ * Usage: check
+ *
+ * Built and run for the host with make check, as build/check
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "ai.h"
+#include "movegen.h"
+#include "rank.h"
+#include "random.h"
+#include "batchwin.h"
+
+static uint16_t failures;
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+static void check(uint8_t passed, const char *text, int line) {
+	if (!passed) {
+		printf("check.c:%d: %s failed\n", line, text);
+		failures++;
+	}
+}
+
+// sets up the position drawn in squares, with player to move. Pieces
+// are added one by one, so a check may give a player more than 4.
+static void set_position(Position *position, const char *squares, uint8_t player) {
+	uint8_t square = 0;
+	position_clear(position);
+	for (; *squares; squares++) {
+		if (*squares == '1' || *squares == '2') {
+			position_add_piece(position, *squares - '0', square);
+		}
+		if (*squares != '/') {
+			square++;
+		}
+	}
+	if (position->player != player) {
+		position_toggle_player(position);
+	}
+}
+
+static uint8_t same_move(Move a, Move b) {
+	return a.from == b.from && a.to == b.to;
+}
+
+// a player with every piece boxed in has lost, for the move generator
+// and the search alike. It takes five pieces to box in four, so the
+// positions are made up.
+static void check_boxed_in(void) {
+	Position position;
+	MoveList list;
+
+	set_position(&position, "112../112../222../...../.....", PLAYER_1);
+	CHECK(generate_moves(&position, &list) == 0);
+	CHECK(position_is_stuck(&position));
+	CHECK(!position_is_won(&position));
+	CHECK(position_is_lost(&position));
+	CHECK(pieces_are_stuck(position.pieces[0], position.pieces[1]));
+
+	// one way out
+	set_position(&position, "112../112../22.../...../.....", PLAYER_1);
+	CHECK(generate_moves(&position, &list) == 1);
+	CHECK(!position_is_stuck(&position));
+	CHECK(!position_is_lost(&position));
+
+	// only the player to move counts, and not before phase 2
+	set_position(&position, "112../112../222../...../.....", PLAYER_2);
+	CHECK(!position_is_lost(&position));
+	CHECK(!pieces_are_stuck(SQUARE_MASK(0) | SQUARE_MASK(1) | SQUARE_MASK(5),
+			SQUARE_MASK(2) | SQUARE_MASK(6) | SQUARE_MASK(7) | SQUARE_MASK(10) | SQUARE_MASK(11)));
+
+	// player 2 boxes player 1 in by moving from (3,3) to (2,2), which the
+	// search scores as a win on the spot rather than a draw
+	Move box_in = {SQUARE(3, 3), SQUARE(2, 2)};
+	set_position(&position, "112../112../22.../...2./.....", PLAYER_2);
+	ai_new_game();
+	ai_search_start(&position);
+	while (ai_search_step(256) && ai_search_depth() < 3) {
+		;
+	}
+	CHECK(same_move(ai_best_move(), box_in));
+	CHECK(ai_best_score() == WIN_SCORE - 1);
+}
+
+// a search stopped part way down the tree, followed by a ponder search
+// that starts from the book, must ponder the position after the book
+// move and not one with the stopped search's moves taken back from it
+static void check_ponder_after_cut(void) {
+	Position position, start, predicted;
+
+	set_position(&position, "1.2../.12../..21./.2.1./.....", PLAYER_1);
+	ai_new_game();
+	ai_search_start(&position);
+	for (uint8_t slice = 0; slice < 5; slice++) {
+		ai_search_step(37);
+	}
+
+	position_clear(&start);
+	ai_ponder_start(&start);
+	CHECK(ai_search_depth() == 0);
+	predicted = start;
+	make_move(&predicted, ai_best_move());
+	ai_ponder_step(256);
+	CHECK(ai_ponder_hit(&predicted));
+}
+
+// every implementation of the batched line check the processor can run
+// must agree with the position's own win check, over whole batches and
+// the ragged end of one
+static void check_batch_wins(void) {
+	static const char *backends[] = {"avx2", "sse2", "scalar"};
+	static uint32_t pieces[2][WIN_BATCH_SIZE];
+	static uint32_t ranks[WIN_BATCH_SIZE];
+	Position position;
+	uint64_t won[2][WIN_BATCH_WORDS];
+	uint32_t random_state = RANDOM_SEED;
+	uint8_t player;
+
+	for (uint8_t n = 0; n < sizeof(backends) / sizeof(backends[0]); n++) {
+		if (!batch_win_use(backends[n])) {
+			printf("no %s line check on this processor, not checked\n", backends[n]);
+			continue;
+		}
+		CHECK(strcmp(batch_win_backend(), backends[n]) == 0);
+		for (uint16_t round = 0; round < 256; round++) {
+			uint16_t count = round % 2 ? WIN_BATCH_SIZE : 1 + random_number(&random_state) % WIN_BATCH_SIZE;
+			// phase 2 ranks, where most of the wins are
+			for (uint16_t i = 0; i < count; i++) {
+				ranks[i] = FIRST_PHASE_2_RANK
+						+ random_number(&random_state) % (NUM_POSITION_RANKS - FIRST_PHASE_2_RANK);
+				unrank_masks(ranks[i], &pieces[0][i], &pieces[1][i], &player);
+			}
+			batch_find_wins(pieces[0], pieces[1], count, won[0], won[1]);
+			for (uint16_t i = 0; i < WIN_BATCH_SIZE; i++) {
+				uint8_t won_1 = (won[0][i / 64] >> (i % 64)) & 1;
+				uint8_t won_2 = (won[1][i / 64] >> (i % 64)) & 1;
+				if (i >= count) {
+					CHECK(!won_1 && !won_2);
+					continue;
+				}
+				unrank_position(ranks[i], &position);
+				CHECK(won_1 == (position.lines_completed[0] != 0));
+				CHECK(won_2 == (position.lines_completed[1] != 0));
+				CHECK((won_1 || won_2) == position_is_won(&position));
+			}
+		}
+	}
+}
+
+int main(void) {
+	check_boxed_in();
+	check_ponder_after_cut();
+	check_batch_wins();
+	if (failures) {
+		printf("%u checks failed\n", failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
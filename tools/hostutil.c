@@ -0,0 +1,35 @@
+/*
+ * hostutil.c
+ *
+ * Random number streams and clocks for the host tools
+ *
+ * Author: Eve
+ */
+
+#include <time.h>
+#include "hostutil.h"
+#include "timer0.h"
+
+uint32_t random_stream(uint32_t seed, uint32_t n) {
+	uint32_t state = seed ^ (n * 0x9E3779B9UL);
+	if (state == 0) {
+		state = 1;
+	}
+	// mixes the nearby seeds of nearby streams apart
+	for (uint8_t i = 0; i < 4; i++) {
+		random_number(&state);
+	}
+	return state;
+}
+
+double now_seconds(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+uint32_t get_current_time(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
@@ -0,0 +1,30 @@
+/*
+ * hostutil.h
+ *
+ * Author: Eve
+ *
+ * Helpers shared by the host tools: independent streams of random
+ * numbers (see random.h) for work shared out between threads, and the
+ * clocks.
+ */
+
+
+#ifndef HOSTUTIL_H_
+#define HOSTUTIL_H_
+
+#include <stdint.h>
+#include "random.h"
+
+// a generator state for the nth of many independent streams from seed,
+// so that work shared out between threads draws the same numbers
+// whichever thread does it
+uint32_t random_stream(uint32_t seed, uint32_t n);
+
+// the seconds since some fixed point, for timing
+double now_seconds(void);
+
+// get_current_time (see timer0.h) is given here too, as milliseconds
+// since some fixed point, for the computer players' time budgets
+
+
+#endif /* HOSTUTIL_H_ */
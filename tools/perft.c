@@ -0,0 +1,375 @@
+/*
+ * perft.c
+ *
+ * Counts the leaves of the game tree to a fixed depth, from the opening
+ * position or a given one, and reports how fast it got there. A won
+ * position has no moves, so games that end early add nothing to the
+ * count. With -d the count under each move from the root is printed as
+ * well (the divide), to narrow a difference down to one move.
+ *
+ * The count is run on one thread and then again with the moves from the
+ * root shared out between threads, and the nodes per second of each is
+ * reported.
+ *
+ * With -g the tree is walked through game.c's rules instead of the move
+ * generator: every square is tried with valid_move and piece_placement,
+ * as the buttons would, so picking up only once all four pieces are down,
+ * moving only to an empty neighbour and not putting a piece back where
+ * it came from are all exercised. At every node the moves found this way
+ * are checked against generate_moves, and the position each leads to
+ * against make_move, and any difference is reported.
+ *
+ * A position is given with -p as 25 squares of ., 1 or 2, row by row
+ * from (0,0) to (4,4) (a / between rows is allowed), then the player to
+ * move, or with -r as its rank (see rank.h).
+ *
+ * Author: Eve
+ *
+ * Usage: perft [-n depth] [-d] [-g] [-t threads] [-p position | -r rank]
+ *
+ * Built for the host with make tools, as build/perft
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "game.h"
+#include "movegen.h"
+#include "rank.h"
+#include "hostutil.h"
+
+#define DEFAULT_DEPTH 5
+#define MAX_THREADS 256
+// mismatches printed before the rest are only counted
+#define MAX_REPORTS 10
+
+static uint8_t use_game;
+static uint64_t mismatches;
+
+// the moves from the root, and the number of leaves under each
+static GameState root;
+static MoveList root_moves;
+static uint64_t root_counts[MAX_MOVES];
+static uint8_t search_depth;
+static uint8_t next_root_move;
+
+static void print_move(FILE *file, Move move) {
+	if (move.from != NO_SQUARE) {
+		fprintf(file, "%u,%u-", SQUARE_X(move.from), SQUARE_Y(move.from));
+	}
+	fprintf(file, "%u,%u", SQUARE_X(move.to), SQUARE_Y(move.to));
+}
+
+static void print_position(FILE *file, const Position *position) {
+	for (uint8_t square = 0; square < WIDTH * HEIGHT; square++) {
+		if (square && square % WIDTH == 0) {
+			fputc('/', file);
+		}
+		uint8_t piece = position_piece_at(position, square);
+		fputc(piece ? '0' + piece : '.', file);
+	}
+	fprintf(file, " %u", position->player);
+}
+
+static uint64_t perft(Position *position, uint8_t depth) {
+	MoveList list;
+	uint64_t count = 0;
+	if (depth == 0) {
+		return 1;
+	}
+	if (position_is_won(position)) {
+		return 0;
+	}
+	generate_moves(position, &list);
+	if (depth == 1) {
+		return list.count;
+	}
+	for (uint8_t i = 0; i < list.count; i++) {
+		make_move(position, list.moves[i]);
+		count += perft(position, depth - 1);
+		unmake_move(position, list.moves[i]);
+	}
+	return count;
+}
+
+// presses the button with the cursor on square
+static void press(GameState *game, uint8_t square) {
+	game->cursor_x = SQUARE_X(square);
+	game->cursor_y = SQUARE_Y(square);
+	piece_placement(game);
+}
+
+// plays a move through game.c, as a player would
+static void game_play(GameState *game, Move move) {
+	if (move.from != NO_SQUARE) {
+		press(game, move.from);
+	}
+	press(game, move.to);
+}
+
+// the moves game.c allows, found by trying every square in turn and,
+// when a piece can be picked up, every square it can then be put on
+static void game_moves(const GameState *game, MoveList *list) {
+	uint8_t player = get_player(game);
+	list->count = 0;
+	for (uint8_t from = 0; from < WIDTH * HEIGHT; from++) {
+		if (!valid_move(game, SQUARE_X(from), SQUARE_Y(from))) {
+			continue;
+		}
+		if (!(game->position.pieces[player - 1] & SQUARE_MASK(from))) {
+			list->moves[list->count].from = NO_SQUARE;
+			list->moves[list->count++].to = from;
+			continue;
+		}
+		GameState lifted = *game;
+		press(&lifted, from);
+		for (uint8_t to = 0; to < WIDTH * HEIGHT; to++) {
+			if (valid_move(&lifted, SQUARE_X(to), SQUARE_Y(to)) && list->count < MAX_MOVES) {
+				list->moves[list->count].from = from;
+				list->moves[list->count++].to = to;
+			}
+		}
+	}
+}
+
+static void report(const Position *position, const char *message, Move move) {
+	if (__atomic_fetch_add(&mismatches, 1, __ATOMIC_RELAXED) < MAX_REPORTS) {
+		flockfile(stderr);
+		print_position(stderr, position);
+		fprintf(stderr, ": %s ", message);
+		print_move(stderr, move);
+		fputc('\n', stderr);
+		funlockfile(stderr);
+	}
+}
+
+// reports any move one list has that the other doesn't
+static void compare_moves(const Position *position, const MoveList *game_list,
+		const MoveList *movegen_list) {
+	uint32_t game_targets[NO_SQUARE + 1] = {0};
+	uint32_t movegen_targets[NO_SQUARE + 1] = {0};
+	for (uint8_t i = 0; i < game_list->count; i++) {
+		game_targets[game_list->moves[i].from] |= SQUARE_MASK(game_list->moves[i].to);
+	}
+	for (uint8_t i = 0; i < movegen_list->count; i++) {
+		Move move = movegen_list->moves[i];
+		if (movegen_targets[move.from] & SQUARE_MASK(move.to)) {
+			report(position, "generate_moves repeats", move);
+		} else if (!(game_targets[move.from] & SQUARE_MASK(move.to))) {
+			report(position, "game.c does not allow", move);
+		}
+		movegen_targets[move.from] |= SQUARE_MASK(move.to);
+	}
+	for (uint8_t i = 0; i < game_list->count; i++) {
+		Move move = game_list->moves[i];
+		if (!(movegen_targets[move.from] & SQUARE_MASK(move.to))) {
+			report(position, "generate_moves misses", move);
+		}
+	}
+}
+
+// the same count, walking the tree through game.c and checking it
+// against the move generator at every node
+static uint64_t perft_game(const GameState *game, uint8_t depth) {
+	MoveList list, movegen_list;
+	uint64_t count = 0;
+	const Position *position = &game->position;
+	if (depth == 0) {
+		return 1;
+	}
+	if (is_game_over(game) != position_is_won(position)) {
+		report(position, "is_game_over disagrees, at", (Move){NO_SQUARE, NO_SQUARE});
+	}
+	if (is_game_over(game)) {
+		return 0;
+	}
+	game_moves(game, &list);
+	generate_moves(position, &movegen_list);
+	compare_moves(position, &list, &movegen_list);
+	for (uint8_t i = 0; i < list.count; i++) {
+		GameState child = *game;
+		Position expected = *position;
+		game_play(&child, list.moves[i]);
+		make_move(&expected, list.moves[i]);
+		if (child.position.pieces[0] != expected.pieces[0]
+				|| child.position.pieces[1] != expected.pieces[1]
+				|| child.position.player != expected.player
+				|| child.position.lifted != expected.lifted
+				|| child.position.key != expected.key) {
+			report(position, "make_move differs from game.c for", list.moves[i]);
+		}
+		count += perft_game(&child, depth - 1);
+	}
+	return count;
+}
+
+// the number of leaves under one move from the root
+static uint64_t count_root_move(Move move) {
+	if (use_game) {
+		GameState child = root;
+		game_play(&child, move);
+		return perft_game(&child, search_depth - 1);
+	}
+	Position position = root.position;
+	make_move(&position, move);
+	return perft(&position, search_depth - 1);
+}
+
+static void *worker_thread(void *arg) {
+	(void)arg;
+	while (1) {
+		uint8_t i = __atomic_fetch_add(&next_root_move, 1, __ATOMIC_RELAXED);
+		if (i >= root_moves.count) {
+			break;
+		}
+		root_counts[i] = count_root_move(root_moves.moves[i]);
+	}
+	return NULL;
+}
+
+// counts the leaves with the moves from the root shared between threads,
+// and returns the total
+static uint64_t run(int num_threads) {
+	pthread_t threads[MAX_THREADS];
+	uint64_t total = 0;
+	next_root_move = 0;
+	for (int i = 0; i < num_threads; i++) {
+		pthread_create(&threads[i], NULL, worker_thread, NULL);
+	}
+	for (int i = 0; i < num_threads; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	for (uint8_t i = 0; i < root_moves.count; i++) {
+		total += root_counts[i];
+	}
+	return total;
+}
+
+// reads a position of 25 squares and the player to move, returning 0 if
+// it isn't one
+static uint8_t parse_position(const char *text, Position *position) {
+	uint8_t square = 0;
+	position_clear(position);
+	for (; *text && square < WIDTH * HEIGHT; text++) {
+		if (*text == '1' || *text == '2') {
+			uint8_t player = *text - '0';
+			if (position->num_pieces[player - 1] == 4) {
+				return 0;
+			}
+			position_add_piece(position, player, square++);
+		} else if (*text == '.') {
+			square++;
+		} else if (*text != '/') {
+			return 0;
+		}
+	}
+	while (*text == ' ') {
+		text++;
+	}
+	if (square < WIDTH * HEIGHT || (text[0] != '1' && text[0] != '2') || text[1]) {
+		return 0;
+	}
+	if (text[0] - '0' != position->player) {
+		position_toggle_player(position);
+	}
+	return 1;
+}
+
+int main(int argc, char *argv[]) {
+	int depth = DEFAULT_DEPTH;
+	int num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	uint8_t divide = 0;
+	const char *position_text = NULL;
+	const char *rank_text = NULL;
+	int option;
+	double start;
+
+	while ((option = getopt(argc, argv, "n:dgt:p:r:")) != -1) {
+		if (option == 'n') {
+			depth = atoi(optarg);
+		} else if (option == 'd') {
+			divide = 1;
+		} else if (option == 'g') {
+			use_game = 1;
+		} else if (option == 't') {
+			num_threads = atoi(optarg);
+		} else if (option == 'p') {
+			position_text = optarg;
+		} else if (option == 'r') {
+			rank_text = optarg;
+		} else {
+			fprintf(stderr, "usage: %s [-n depth] [-d] [-g] [-t threads] [-p position | -r rank]\n",
+					argv[0]);
+			return 1;
+		}
+	}
+	if (depth < 1 || depth > 255) {
+		fprintf(stderr, "depth must be from 1 to 255\n");
+		return 1;
+	}
+	if (num_threads < 1) {
+		num_threads = 1;
+	} else if (num_threads > MAX_THREADS) {
+		num_threads = MAX_THREADS;
+	}
+	search_depth = depth;
+
+	initialise_game(&root, 0);
+	if (position_text && !parse_position(position_text, &root.position)) {
+		fprintf(stderr, "not a position: %s\n", position_text);
+		return 1;
+	}
+	if (rank_text) {
+		unsigned long rank = strtoul(rank_text, NULL, 10);
+		if (rank >= NUM_POSITION_RANKS) {
+			fprintf(stderr, "ranks go up to %lu\n", NUM_POSITION_RANKS - 1);
+			return 1;
+		}
+		unrank_position(rank, &root.position);
+	}
+	print_position(stdout, &root.position);
+	printf(", depth %u%s\n", search_depth, use_game ? ", through game.c" : "");
+
+	if (position_is_won(&root.position)) {
+		root_moves.count = 0;
+	} else if (use_game) {
+		MoveList movegen_list;
+		game_moves(&root, &root_moves);
+		generate_moves(&root.position, &movegen_list);
+		compare_moves(&root.position, &root_moves, &movegen_list);
+	} else {
+		generate_moves(&root.position, &root_moves);
+	}
+
+	start = now_seconds();
+	uint64_t nodes = run(1);
+	double seconds = now_seconds() - start;
+	if (divide) {
+		for (uint8_t i = 0; i < root_moves.count; i++) {
+			print_move(stdout, root_moves.moves[i]);
+			printf(" %lu\n", (unsigned long)root_counts[i]);
+		}
+	}
+	printf("%lu nodes\n", (unsigned long)nodes);
+	printf("1 thread: %.3fs, %.0f nodes/s\n", seconds, nodes / seconds);
+
+	if (num_threads > 1) {
+		start = now_seconds();
+		uint64_t threaded_nodes = run(num_threads);
+		seconds = now_seconds() - start;
+		printf("%d threads: %.3fs, %.0f nodes/s\n", num_threads, seconds, threaded_nodes / seconds);
+		if (threaded_nodes != nodes) {
+			fprintf(stderr, "the threaded count differs: %lu nodes\n", (unsigned long)threaded_nodes);
+			return 1;
+		}
+	}
+	if (mismatches) {
+		fprintf(stderr, "%lu differences between game.c and the move generator\n",
+				(unsigned long)mismatches);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,36 @@
+/*
+ * solution.h
+ *
+ * Author: Eve
+ *
+ * Format of the raw solution file written by the solver (tools/solve.c).
+ * The file is a SolutionHeader followed by a 2-bit result for every
+ * position rank (4 to a byte, lowest rank in the low bits) and then a
+ * distance byte for every position rank. Results are from the point of
+ * view of the player to move. The distance is the number of moves (plies)
+ * until the game is won with best play, or DISTANCE_DRAW for a draw.
+ */
+
+
+#ifndef SOLUTION_H_
+#define SOLUTION_H_
+
+#include <stdint.h>
+
+#define SOLUTION_MAGIC "TEEKOSOL"
+#define SOLUTION_VERSION 1
+
+#define RESULT_DRAW 0
+#define RESULT_WIN 1
+#define RESULT_LOSS 2
+
+#define DISTANCE_DRAW 255
+
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t num_positions;
+} SolutionHeader;
+
+
+#endif /* SOLUTION_H_ */
@@ -0,0 +1,412 @@
+/*
+ * solve.c
+ *
+ * Solves Teeko by retrograde analysis, finding the result and distance to
+ * the end of the game for every legal position, and writes them out in
+ * the format described in solution.h.
+ *
+ * Phase 2 positions can repeat, so they are solved backwards from the
+ * finished games: each pass takes the positions resolved in the previous
+ * pass and looks at the positions one move before them. A position is a
+ * win as soon as one move leads to a loss for the opponent, and a loss
+ * once every move has been found to lead to a win for the opponent. What
+ * is left when a pass resolves nothing is a draw. Phase 1 positions only
+ * lead to positions with more pieces, so they are then solved one class
+ * at a time from the last drop back to the empty board.
+ *
+ * The work in each pass is split into chunks of ranks which the threads
+ * take from a shared counter as they finish their previous chunk, so
+ * faster threads pick up the work slower threads have not got to.
+ * Positions are unranked WIN_BATCH_SIZE at a time, so that finding which
+ * of them are already won is done for the whole batch at once (see
+ * batchwin.h), with the best implementation the processor has unless
+ * -b names another (avx2, sse2 or scalar), to compare them.
+ *
+ * Author: Eve
+ *
+ * Usage: solve [-t threads] [-b avx2|sse2|scalar] [-o file]
+ *
+ * Built for the host with make tools, as build/solve
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "rank.h"
+#include "movegen.h"
+#include "solution.h"
+#include "batchwin.h"
+#include "hostutil.h"
+
+#define CHUNK_SIZE 65536
+#define MAX_THREADS 256
+
+// results are packed 4 to a byte, and the distance of a position is only
+// meaningful once it has a result. move_counts holds, for each unresolved
+// phase 2 position, the number of moves not yet known to lose.
+static uint8_t *results;
+static uint8_t *distances;
+static uint8_t *move_counts;
+
+static int num_threads;
+
+typedef void (*RangeWorker)(uint32_t first, uint32_t last, uint32_t *resolved);
+
+static uint32_t next_rank;
+static uint32_t last_rank;
+static RangeWorker range_worker;
+static uint32_t total_resolved;
+
+static uint8_t get_result(uint32_t rank) {
+	uint8_t byte = __atomic_load_n(&results[rank >> 2], __ATOMIC_ACQUIRE);
+	return (byte >> ((rank & 3) * 2)) & 3;
+}
+
+// sets the result of an unresolved position, returning 0 if another
+// thread got there first. The distance is written before the result is
+// published so any thread that sees the result also sees the distance.
+static uint8_t set_result(uint32_t rank, uint8_t result, uint8_t distance) {
+	uint8_t *byte = &results[rank >> 2];
+	uint8_t shift = (rank & 3) * 2;
+	uint8_t old = __atomic_load_n(byte, __ATOMIC_RELAXED);
+	if ((old >> shift) & 3) {
+		return 0;
+	}
+	// two threads can only race to set the same position in the same
+	// pass, when they would both give it the same result and distance
+	distances[rank] = distance;
+	do {
+		if ((old >> shift) & 3) {
+			return 0;
+		}
+	} while (!__atomic_compare_exchange_n(byte, &old, old | (result << shift), 1,
+			__ATOMIC_RELEASE, __ATOMIC_RELAXED));
+	return 1;
+}
+
+static void *worker_thread(void *arg) {
+	uint32_t resolved = 0;
+	(void)arg;
+	while (1) {
+		uint32_t first = __atomic_fetch_add(&next_rank, CHUNK_SIZE, __ATOMIC_RELAXED);
+		if (first >= last_rank) {
+			break;
+		}
+		uint32_t last = first + CHUNK_SIZE;
+		if (last > last_rank) {
+			last = last_rank;
+		}
+		range_worker(first, last, &resolved);
+	}
+	__atomic_fetch_add(&total_resolved, resolved, __ATOMIC_RELAXED);
+	return NULL;
+}
+
+// runs worker over every rank from first up to (not including) last,
+// spread over all the threads, and returns the total number of positions
+// the workers resolved
+static uint32_t parallel_for(uint32_t first, uint32_t last, RangeWorker worker) {
+	pthread_t threads[MAX_THREADS];
+	next_rank = first;
+	last_rank = last;
+	range_worker = worker;
+	total_resolved = 0;
+	for (int i = 0; i < num_threads; i++) {
+		pthread_create(&threads[i], NULL, worker_thread, NULL);
+	}
+	for (int i = 0; i < num_threads; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	return total_resolved;
+}
+
+// a batch of consecutive ranks, unranked, with the players who have four
+// in a line in each
+typedef struct {
+	uint32_t pieces[2][WIN_BATCH_SIZE];
+	uint8_t players[WIN_BATCH_SIZE];
+	uint64_t won[2][WIN_BATCH_WORDS];
+} Batch;
+
+// unranks the ranks from first, up to WIN_BATCH_SIZE of them but not
+// reaching last, and returns how many there are
+static uint16_t unrank_batch(uint32_t first, uint32_t last, Batch *batch) {
+	uint16_t count = last - first < WIN_BATCH_SIZE ? last - first : WIN_BATCH_SIZE;
+	for (uint16_t i = 0; i < count; i++) {
+		unrank_masks(first + i, &batch->pieces[0][i], &batch->pieces[1][i], &batch->players[i]);
+	}
+	batch_find_wins(batch->pieces[0], batch->pieces[1], count, batch->won[0], batch->won[1]);
+	return count;
+}
+
+// returns 1 if the player has four in a line in position i of the batch
+static uint8_t batch_won(const Batch *batch, uint8_t player, uint16_t i) {
+	return (batch->won[player - 1][i / 64] >> (i % 64)) & 1;
+}
+
+// returns the number of moves available to the player with pieces own
+static uint8_t count_moves(uint32_t own, uint32_t empty) {
+	uint8_t count = 0;
+	while (own) {
+		uint8_t from = __builtin_ctzl(own);
+		own &= own - 1;
+		count += __builtin_popcountl(get_neighbours(from) & empty);
+	}
+	return count;
+}
+
+// finds the positions which are already over, and counts the moves in the
+// rest, for the phase 2 ranks first to last
+static void initialise_phase_2(uint32_t first, uint32_t last, uint32_t *resolved) {
+	Batch batch;
+	for (uint32_t base = first; base < last; base += WIN_BATCH_SIZE) {
+		uint16_t count = unrank_batch(base, last, &batch);
+		for (uint16_t i = 0; i < count; i++) {
+			uint32_t rank = base + i;
+			uint8_t player = batch.players[i];
+			uint32_t own = batch.pieces[player - 1][i];
+			uint32_t other = batch.pieces[OPPONENT(player) - 1][i];
+			uint8_t moves = 0;
+			if (batch_won(&batch, OPPONENT(player), i)) {
+				set_result(rank, RESULT_LOSS, 0);
+				(*resolved)++;
+			} else if (batch_won(&batch, player, i)) {
+				// can't happen in a real game, the player would have won
+				// on their last move
+				set_result(rank, RESULT_WIN, 0);
+				(*resolved)++;
+			} else {
+				moves = count_moves(own, ~(own | other) & BOARD_MASK);
+				if (pieces_are_stuck(own, other)) {
+					// a player who cannot move loses, as everywhere else
+					// (see position_is_lost)
+					set_result(rank, RESULT_LOSS, 0);
+					(*resolved)++;
+				}
+			}
+			move_counts[rank - FIRST_PHASE_2_RANK] = moves;
+		}
+	}
+}
+
+static uint8_t current_pass;
+
+// for each position resolved in the previous pass, updates the positions
+// one move earlier
+static void retrograde_pass(uint32_t first, uint32_t last, uint32_t *resolved) {
+	uint8_t previous = current_pass - 1;
+	for (uint32_t rank = first; rank < last; rank++) {
+		uint8_t result = get_result(rank);
+		if (result == RESULT_DRAW || distances[rank] != previous) {
+			continue;
+		}
+		uint32_t pieces[2];
+		uint8_t player;
+		unrank_masks(rank, &pieces[0], &pieces[1], &player);
+		// the opponent made the last move, by sliding one of their pieces
+		// onto its current square from an empty neighbouring square
+		uint8_t mover = OPPONENT(player);
+		uint32_t moved = pieces[mover - 1];
+		uint32_t empty = ~(pieces[0] | pieces[1]) & BOARD_MASK;
+		while (moved) {
+			uint8_t to = __builtin_ctzl(moved);
+			uint32_t froms = get_neighbours(to) & empty;
+			moved &= moved - 1;
+			while (froms) {
+				uint8_t from = __builtin_ctzl(froms);
+				froms &= froms - 1;
+				uint32_t before[2] = {pieces[0], pieces[1]};
+				before[mover - 1] ^= SQUARE_MASK(to) | SQUARE_MASK(from);
+				uint32_t parent = rank_masks(before[0], before[1], mover);
+				if (get_result(parent) != RESULT_DRAW) {
+					continue;
+				}
+				if (result == RESULT_LOSS) {
+					*resolved += set_result(parent, RESULT_WIN, current_pass);
+				} else if (__atomic_sub_fetch(&move_counts[parent - FIRST_PHASE_2_RANK], 1,
+						__ATOMIC_ACQ_REL) == 0) {
+					*resolved += set_result(parent, RESULT_LOSS, current_pass);
+				}
+			}
+		}
+	}
+}
+
+// solves phase 1 positions from the results of the positions after them
+static void solve_phase_1(uint32_t first, uint32_t last, uint32_t *resolved) {
+	Batch batch;
+	for (uint32_t base = first; base < last; base += WIN_BATCH_SIZE) {
+		uint16_t count = unrank_batch(base, last, &batch);
+		for (uint16_t i = 0; i < count; i++) {
+			uint32_t rank = base + i;
+			uint8_t player = batch.players[i];
+			uint32_t pieces[2] = {batch.pieces[0][i], batch.pieces[1][i]};
+			uint32_t own = pieces[player - 1];
+			uint32_t other = pieces[OPPONENT(player) - 1];
+			if (batch_won(&batch, OPPONENT(player), i)) {
+				*resolved += set_result(rank, RESULT_LOSS, 0);
+				continue;
+			}
+			if (batch_won(&batch, player, i)) {
+				*resolved += set_result(rank, RESULT_WIN, 0);
+				continue;
+			}
+			// best play wins as quickly as possible, or loses as slowly as
+			// possible
+			uint8_t draw = 0;
+			uint16_t win_distance = 256;
+			uint16_t loss_distance = 0;
+			uint32_t empty = ~(own | other) & BOARD_MASK;
+			while (empty) {
+				uint32_t to = SQUARE_MASK(__builtin_ctzl(empty));
+				empty &= empty - 1;
+				uint32_t after[2] = {pieces[0], pieces[1]};
+				after[player - 1] |= to;
+				uint32_t child = rank_masks(after[0], after[1], OPPONENT(player));
+				uint8_t result = get_result(child);
+				if (result == RESULT_LOSS) {
+					if (distances[child] + 1 < win_distance) {
+						win_distance = distances[child] + 1;
+					}
+				} else if (result == RESULT_WIN) {
+					if (distances[child] + 1 > loss_distance) {
+						loss_distance = distances[child] + 1;
+					}
+				} else {
+					draw = 1;
+				}
+			}
+			uint8_t result;
+			uint16_t distance;
+			if (win_distance < 256) {
+				result = RESULT_WIN;
+				distance = win_distance;
+			} else if (!draw) {
+				result = RESULT_LOSS;
+				distance = loss_distance;
+			} else {
+				continue;
+			}
+			if (distance >= DISTANCE_DRAW) {
+				fprintf(stderr, "distance too long to store\n");
+				exit(1);
+			}
+			*resolved += set_result(rank, result, distance);
+		}
+	}
+}
+
+static void print_summary(void) {
+	printf("class  pieces  player        wins      losses       draws  longest\n");
+	for (uint8_t class_number = 0; class_number < NUM_RANK_CLASSES; class_number++) {
+		uint32_t first = rank_class_offset(class_number);
+		uint32_t last = first + rank_class_size(class_number);
+		uint32_t counts[3] = {0, 0, 0};
+		uint8_t longest = 0;
+		for (uint32_t rank = first; rank < last; rank++) {
+			uint8_t result = get_result(rank);
+			counts[result]++;
+			if (result != RESULT_DRAW && distances[rank] > longest) {
+				longest = distances[rank];
+			}
+		}
+		printf("%5u  %u + %u  %6u  %10u  %10u  %10u  %7u\n", class_number,
+				rank_class_pieces(class_number, PLAYER_1),
+				rank_class_pieces(class_number, PLAYER_2),
+				rank_class_player(class_number),
+				counts[RESULT_WIN], counts[RESULT_LOSS], counts[RESULT_DRAW], longest);
+	}
+	static const char *names[3] = {"draw", "win", "loss"};
+	printf("start position: %s for player 1\n", names[get_result(0)]);
+}
+
+static int write_solution(const char *filename) {
+	FILE *file = fopen(filename, "wb");
+	if (!file) {
+		perror(filename);
+		return 1;
+	}
+	SolutionHeader header;
+	memcpy(header.magic, SOLUTION_MAGIC, sizeof(header.magic));
+	header.version = SOLUTION_VERSION;
+	header.num_positions = NUM_POSITION_RANKS;
+	size_t result_bytes = (NUM_POSITION_RANKS + 3) / 4;
+	if (fwrite(&header, sizeof(header), 1, file) != 1
+			|| fwrite(results, 1, result_bytes, file) != result_bytes
+			|| fwrite(distances, 1, NUM_POSITION_RANKS, file) != NUM_POSITION_RANKS) {
+		perror(filename);
+		fclose(file);
+		return 1;
+	}
+	return fclose(file) != 0;
+}
+
+int main(int argc, char *argv[]) {
+	const char *filename = "teeko.sol";
+	int option;
+	double start;
+	
+	num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	while ((option = getopt(argc, argv, "t:b:o:")) != -1) {
+		if (option == 't') {
+			num_threads = atoi(optarg);
+		} else if (option == 'b') {
+			if (!batch_win_use(optarg)) {
+				fprintf(stderr, "no %s line check on this processor\n", optarg);
+				return 1;
+			}
+		} else if (option == 'o') {
+			filename = optarg;
+		} else {
+			fprintf(stderr, "usage: %s [-t threads] [-b avx2|sse2|scalar] [-o file]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (num_threads < 1) {
+		num_threads = 1;
+	} else if (num_threads > MAX_THREADS) {
+		num_threads = MAX_THREADS;
+	}
+	
+	results = calloc((NUM_POSITION_RANKS + 3) / 4, 1);
+	distances = malloc(NUM_POSITION_RANKS);
+	move_counts = malloc(NUM_POSITION_RANKS - FIRST_PHASE_2_RANK);
+	if (!results || !distances || !move_counts) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	memset(distances, DISTANCE_DRAW, NUM_POSITION_RANKS);
+	start = now_seconds();
+	
+	uint32_t resolved = parallel_for(FIRST_PHASE_2_RANK, NUM_POSITION_RANKS, initialise_phase_2);
+	printf("%u threads, %s line checks, %u finished phase 2 positions (%.1fs)\n",
+			num_threads, batch_win_backend(), resolved, now_seconds() - start);
+	for (current_pass = 1; resolved; current_pass++) {
+		if (current_pass == DISTANCE_DRAW) {
+			fprintf(stderr, "distance too long to store\n");
+			return 1;
+		}
+		resolved = parallel_for(FIRST_PHASE_2_RANK, NUM_POSITION_RANKS, retrograde_pass);
+		printf("pass %u: %u resolved (%.1fs)\n", current_pass, resolved, now_seconds() - start);
+		fflush(stdout);
+	}
+	free(move_counts);
+	
+	// the phase 1 classes come before phase 2 in rank order, and each
+	// only leads to the class after it
+	for (int8_t class_number = 7; class_number >= 0; class_number--) {
+		uint32_t first = rank_class_offset(class_number);
+		parallel_for(first, first + rank_class_size(class_number), solve_phase_1);
+	}
+	printf("phase 1 solved (%.1fs)\n", now_seconds() - start);
+	
+	print_summary();
+	if (write_solution(filename)) {
+		return 1;
+	}
+	printf("wrote %s\n", filename);
+	return 0;
+}
@@ -0,0 +1,308 @@
+/*
+ * tablebase.c
+ *
+ * Reading and probing compressed Teeko tablebases
+ *
+ * Author: Eve
+ */
+
+#include "tablebase.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "rank.h"
+#include "symmetry.h"
+#include "solution.h"
+
+// the cache is split into sets by block number, and within each set the
+// least recently used block is replaced. A block is only decompressed
+// into the cache the second time in a row it misses in its set; a single
+// probe reads its entry straight from the packets, which is much cheaper
+// than decompressing the whole block, so scattered probes don't thrash
+// the cache while probes near each other still get to use it.
+#define CACHE_SETS 64
+#define CACHE_WAYS 4
+#define NO_BLOCK 0xFFFFFFFFUL
+
+typedef struct {
+	uint32_t block;
+	uint32_t last_used;
+	uint8_t entries[TABLEBASE_BLOCK_SIZE];
+} CachedBlock;
+
+#define NUM_BLOCKS ((NUM_POSITION_RANKS + TABLEBASE_BLOCK_SIZE - 1) / TABLEBASE_BLOCK_SIZE)
+
+struct Tablebase {
+	const uint8_t *data;
+	size_t size;
+	const TablebaseHeader *header;
+	const uint64_t *offsets;
+	uint32_t clock;
+	// the block that last missed in each set
+	uint32_t missed[CACHE_SETS];
+	CachedBlock cache[CACHE_SETS][CACHE_WAYS];
+};
+
+// the number of entries in a block, which is less than the block size
+// for the last one
+static uint32_t block_entries(uint32_t block) {
+	uint32_t count = NUM_POSITION_RANKS - block * TABLEBASE_BLOCK_SIZE;
+	return count < TABLEBASE_BLOCK_SIZE ? count : TABLEBASE_BLOCK_SIZE;
+}
+
+// checks that the offsets table is inside the file, and that the blocks
+// follow it in order, each no bigger than its entries and all inside the
+// file, so that probes never read outside the map
+static uint8_t offsets_valid(const uint8_t *data, size_t size) {
+	size_t table_end = sizeof(TablebaseHeader) + (NUM_BLOCKS + 1) * sizeof(uint64_t);
+	if (size < table_end) {
+		return 0;
+	}
+	const uint64_t *offsets = (const uint64_t *)(data + sizeof(TablebaseHeader));
+	if (offsets[0] < table_end || offsets[NUM_BLOCKS] > size) {
+		return 0;
+	}
+	for (uint32_t block = 0; block < NUM_BLOCKS; block++) {
+		if (offsets[block + 1] < offsets[block]
+				|| offsets[block + 1] - offsets[block] > block_entries(block)) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+Tablebase *tablebase_open(const char *filename) {
+	int file = open(filename, O_RDONLY);
+	struct stat info;
+	if (file < 0 || fstat(file, &info) < 0) {
+		perror(filename);
+		if (file >= 0) {
+			close(file);
+		}
+		return NULL;
+	}
+	void *data = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, file, 0);
+	close(file);
+	if (data == MAP_FAILED) {
+		perror(filename);
+		return NULL;
+	}
+	
+	const TablebaseHeader *header = data;
+	if ((size_t)info.st_size < sizeof(TablebaseHeader)
+			|| memcmp(header->magic, TABLEBASE_MAGIC, sizeof(header->magic)) != 0
+			|| header->version != TABLEBASE_VERSION
+			|| header->num_positions != NUM_POSITION_RANKS
+			|| header->block_size != TABLEBASE_BLOCK_SIZE
+			|| header->num_blocks != NUM_BLOCKS) {
+		fprintf(stderr, "%s: not a Teeko tablebase\n", filename);
+		munmap(data, info.st_size);
+		return NULL;
+	}
+	if (!offsets_valid(data, info.st_size)) {
+		fprintf(stderr, "%s: block offsets are damaged or the file is cut short\n", filename);
+		munmap(data, info.st_size);
+		return NULL;
+	}
+	
+	Tablebase *tablebase = malloc(sizeof(Tablebase));
+	if (!tablebase) {
+		munmap(data, info.st_size);
+		return NULL;
+	}
+	tablebase->data = data;
+	tablebase->size = info.st_size;
+	tablebase->header = header;
+	tablebase->offsets = (const uint64_t *)(header + 1);
+	tablebase->clock = 0;
+	for (int set = 0; set < CACHE_SETS; set++) {
+		tablebase->missed[set] = NO_BLOCK;
+		for (int way = 0; way < CACHE_WAYS; way++) {
+			tablebase->cache[set][way].block = NO_BLOCK;
+			tablebase->cache[set][way].last_used = 0;
+		}
+	}
+	return tablebase;
+}
+
+void tablebase_close(Tablebase *tablebase) {
+	if (tablebase) {
+		munmap((void *)tablebase->data, tablebase->size);
+		free(tablebase);
+	}
+}
+
+// Blocks are compressed as a sequence of packets, each starting with a
+// control byte. A control byte below 128 is followed by that many plus one
+// entries copied as they are, and one of 128 or more is followed by a
+// single entry repeated (control - 128 + MIN_RUN) times. Long runs of the
+// same entry are common where most ranks are not canonical, and the
+// canonical parts of the table become runs of copied entries, which are
+// quick to decompress. A block that doesn't shrink is stored as it is and
+// read straight from the file without going through the cache.
+#define MIN_RUN 3
+#define MAX_RUN (127 + MIN_RUN)
+#define MAX_COPY 128
+
+uint32_t tablebase_compress_block(const uint8_t *entries, uint32_t count, uint8_t *out) {
+	uint32_t size = 0;
+	uint32_t i = 0;
+	while (i < count) {
+		uint32_t run = 1;
+		while (i + run < count && run < MAX_RUN && entries[i + run] == entries[i]) {
+			run++;
+		}
+		if (run >= MIN_RUN) {
+			out[size++] = 128 + run - MIN_RUN;
+			out[size++] = entries[i];
+			i += run;
+		} else {
+			// copy entries up to the start of the next long enough run
+			uint32_t copy = 0;
+			while (i + copy < count && copy < MAX_COPY) {
+				if (i + copy + MIN_RUN <= count
+						&& entries[i + copy] == entries[i + copy + 1]
+						&& entries[i + copy] == entries[i + copy + 2]) {
+					break;
+				}
+				copy++;
+			}
+			out[size++] = copy - 1;
+			memcpy(&out[size], &entries[i], copy);
+			size += copy;
+			i += copy;
+		}
+		if (size >= count) {
+			memcpy(out, entries, count);
+			return count;
+		}
+	}
+	return size;
+}
+
+// packets that would run past the end of the block's data or entries are
+// left out, so a damaged block gives wrong entries rather than a crash
+static void decompress_block(const uint8_t *in, uint64_t size, uint8_t *entries) {
+	const uint8_t *end = in + size;
+	uint8_t *entries_end = entries + TABLEBASE_BLOCK_SIZE;
+	while (in < end) {
+		uint8_t control = *in++;
+		if (control < 128) {
+			if (control + 1 > end - in || control + 1 > entries_end - entries) {
+				return;
+			}
+			memcpy(entries, in, control + 1);
+			entries += control + 1;
+			in += control + 1;
+		} else {
+			uint32_t run = control - 128 + MIN_RUN;
+			if (in == end || run > (uint32_t)(entries_end - entries)) {
+				return;
+			}
+			memset(entries, *in++, run);
+			entries += run;
+		}
+	}
+}
+
+// returns entry index of a compressed block, skipping over the packets
+// before it by their control bytes
+static uint8_t find_entry(const uint8_t *in, uint64_t size, uint32_t index) {
+	const uint8_t *end = in + size;
+	while (in < end) {
+		uint8_t control = *in++;
+		if (control < 128) {
+			if (index <= control) {
+				return in + index < end ? in[index] : 0;
+			}
+			index -= control + 1;
+			in += control + 1;
+		} else {
+			uint32_t run = control - 128 + MIN_RUN;
+			if (index < run) {
+				return in < end ? *in : 0;
+			}
+			index -= run;
+			in++;
+		}
+	}
+	return 0;
+}
+
+// returns the decompressed entries of a block if they are in the cache,
+// or NULL after decompressing them into the cache if the block also
+// missed last time, or just NULL
+static const uint8_t *get_block(Tablebase *tablebase, uint32_t block) {
+	CachedBlock *set = tablebase->cache[block % CACHE_SETS];
+	CachedBlock *oldest = &set[0];
+	tablebase->clock++;
+	for (int way = 0; way < CACHE_WAYS; way++) {
+		if (set[way].block == block) {
+			set[way].last_used = tablebase->clock;
+			return set[way].entries;
+		}
+		if (set[way].last_used < oldest->last_used) {
+			oldest = &set[way];
+		}
+	}
+	uint32_t *missed = &tablebase->missed[block % CACHE_SETS];
+	if (*missed != block) {
+		*missed = block;
+		return NULL;
+	}
+	*missed = NO_BLOCK;
+	uint64_t start = tablebase->offsets[block];
+	decompress_block(tablebase->data + start, tablebase->offsets[block + 1] - start,
+			oldest->entries);
+	oldest->block = block;
+	oldest->last_used = tablebase->clock;
+	return oldest->entries;
+}
+
+uint8_t tablebase_entry(Tablebase *tablebase, uint32_t rank) {
+	uint32_t block = rank / TABLEBASE_BLOCK_SIZE;
+	uint32_t first = block * TABLEBASE_BLOCK_SIZE;
+	uint32_t count = block_entries(block);
+	uint64_t start = tablebase->offsets[block];
+	if (tablebase->offsets[block + 1] - start == count) {
+		// stored uncompressed
+		return tablebase->data[start + rank - first];
+	}
+	const uint8_t *entries = get_block(tablebase, block);
+	if (!entries) {
+		return find_entry(tablebase->data + start, tablebase->offsets[block + 1] - start,
+				rank - first);
+	}
+	return entries[rank - first];
+}
+
+int tablebase_probe_masks(Tablebase *tablebase, uint32_t pieces_1, uint32_t pieces_2,
+		uint8_t player, uint8_t *result, uint8_t *distance) {
+	// overlapping masks or squares off the board would be ranked as some
+	// other position
+	if ((pieces_1 & pieces_2) || ((pieces_1 | pieces_2) & ~BOARD_MASK)) {
+		return -1;
+	}
+	if (rank_class(__builtin_popcountl(pieces_1), __builtin_popcountl(pieces_2), player)
+			== NUM_RANK_CLASSES) {
+		return -1;
+	}
+	canonicalise_masks(&pieces_1, &pieces_2);
+	uint8_t entry = tablebase_entry(tablebase, rank_masks(pieces_1, pieces_2, player));
+	*result = TABLEBASE_RESULT(entry);
+	*distance = TABLEBASE_DISTANCE(entry);
+	return 0;
+}
+
+int tablebase_probe(Tablebase *tablebase, const Position *position,
+		uint8_t *result, uint8_t *distance) {
+	if (position->lifted != NO_SQUARE) {
+		return -1;
+	}
+	return tablebase_probe_masks(tablebase, position->pieces[0], position->pieces[1],
+			position->player, result, distance);
+}
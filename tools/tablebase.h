@@ -0,0 +1,83 @@
+/*
+ * tablebase.h
+ *
+ * Author: Eve
+ *
+ * Compressed Teeko tablebase, built from the solver's output by tbgen.
+ *
+ * The file holds a result and distance for every position rank (see
+ * rank.h), stored as one byte per rank with the result in the top 2 bits
+ * and the distance in the low 6 (rather than 2 bits of result alone, so
+ * that probes can give the distance too). Symmetric positions share a
+ * result, so only ranks whose bitboards are already canonical
+ * (canonicalise_masks) hold their own value; every other rank repeats
+ * the value before it, which the run length encoding then stores almost
+ * for free. The ranks are split into blocks of TABLEBASE_BLOCK_SIZE
+ * which are compressed separately, and a table of block offsets follows
+ * the header.
+ *
+ * Files are read with mmap, and each open Tablebase keeps a small cache
+ * of decompressed blocks, so opening is instant and only the blocks that
+ * are probed are ever read from disk. A probe of a block that isn't
+ * cached reads its entry by skipping through the block's packets, and
+ * the block is only decompressed into the cache if it is probed again.
+ * A Tablebase must only be used by one thread at a time; threads should
+ * open their own.
+ */
+
+
+#ifndef TABLEBASE_H_
+#define TABLEBASE_H_
+
+#include <stdint.h>
+#include "position.h"
+
+#define TABLEBASE_MAGIC "TEEKOTB1"
+#define TABLEBASE_VERSION 1
+#define TABLEBASE_BLOCK_SIZE 1024
+
+// distances longer than this can't be stored
+#define TABLEBASE_MAX_DISTANCE 63
+
+#define TABLEBASE_ENTRY(result, distance) ((uint8_t)(((result) << 6) | (distance)))
+#define TABLEBASE_RESULT(entry) ((entry) >> 6)
+#define TABLEBASE_DISTANCE(entry) ((entry) & 0x3F)
+
+// the offsets of the compressed blocks follow the header, and are
+// measured from the start of the file
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t num_positions;
+	uint32_t block_size;
+	uint32_t num_blocks;
+} TablebaseHeader;
+
+typedef struct Tablebase Tablebase;
+
+// opens a tablebase file, returning NULL (and printing why) on failure
+Tablebase *tablebase_open(const char *filename);
+void tablebase_close(Tablebase *tablebase);
+
+// looks up a position, setting result to RESULT_WIN, RESULT_LOSS or
+// RESULT_DRAW (see solution.h) for the player to move and distance to the
+// number of moves until the game ends with best play (0 for a draw).
+// Returns 0 on success, or -1 if the position can't be looked up (it has
+// a lifted piece, impossible piece counts, both players on one square or
+// pieces off the board).
+int tablebase_probe(Tablebase *tablebase, const Position *position,
+		uint8_t *result, uint8_t *distance);
+int tablebase_probe_masks(Tablebase *tablebase, uint32_t pieces_1, uint32_t pieces_2,
+		uint8_t player, uint8_t *result, uint8_t *distance);
+
+// returns the entry stored for a rank, without canonicalising it first
+uint8_t tablebase_entry(Tablebase *tablebase, uint32_t rank);
+
+// compresses a block of entries (at most TABLEBASE_BLOCK_SIZE) into out,
+// which must have room for twice as many bytes, and returns the
+// compressed size. A block that doesn't shrink is copied to out as it is
+// and its entry count returned.
+uint32_t tablebase_compress_block(const uint8_t *entries, uint32_t count, uint8_t *out);
+
+
+#endif /* TABLEBASE_H_ */
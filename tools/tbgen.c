@@ -0,0 +1,202 @@
+/*
+ * tbgen.c
+ *
+ * Builds a compressed tablebase (see tablebase.h) from the raw solution
+ * written by the solver, then checks a sample of positions against the
+ * solution by probing the new file and reports the probe rate.
+ *
+ * Author: Eve
+ *
+ * Usage: tbgen [-i solution] [-o tablebase]
+ *
+ * Built for the host with make tools, as build/tbgen
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "rank.h"
+#include "symmetry.h"
+#include "solution.h"
+#include "tablebase.h"
+#include "hostutil.h"
+
+#define NUM_CHECKS 10000000UL
+// positions made ready for probing at a time, so that only the probes are
+// timed and not unranking the positions or reading the solution
+#define CHECK_BATCH 65536
+
+static uint8_t *results;
+static uint8_t *distances;
+
+static int read_solution(const char *filename) {
+	FILE *file = fopen(filename, "rb");
+	SolutionHeader header;
+	size_t result_bytes = (NUM_POSITION_RANKS + 3) / 4;
+	if (!file) {
+		perror(filename);
+		return 1;
+	}
+	results = malloc(result_bytes);
+	distances = malloc(NUM_POSITION_RANKS);
+	if (fread(&header, sizeof(header), 1, file) != 1
+			|| memcmp(header.magic, SOLUTION_MAGIC, sizeof(header.magic)) != 0
+			|| header.version != SOLUTION_VERSION
+			|| header.num_positions != NUM_POSITION_RANKS) {
+		fprintf(stderr, "%s: not a Teeko solution\n", filename);
+		fclose(file);
+		return 1;
+	}
+	if (!results || !distances
+			|| fread(results, 1, result_bytes, file) != result_bytes
+			|| fread(distances, 1, NUM_POSITION_RANKS, file) != NUM_POSITION_RANKS) {
+		fprintf(stderr, "%s: could not read solution\n", filename);
+		fclose(file);
+		return 1;
+	}
+	fclose(file);
+	return 0;
+}
+
+static uint8_t solution_entry(uint32_t rank) {
+	uint8_t result = (results[rank >> 2] >> ((rank & 3) * 2)) & 3;
+	if (result == RESULT_DRAW) {
+		return TABLEBASE_ENTRY(RESULT_DRAW, 0);
+	}
+	return TABLEBASE_ENTRY(result, distances[rank]);
+}
+
+static int write_tablebase(const char *filename) {
+	FILE *file = fopen(filename, "wb");
+	if (!file) {
+		perror(filename);
+		return 1;
+	}
+	TablebaseHeader header;
+	memcpy(header.magic, TABLEBASE_MAGIC, sizeof(header.magic));
+	header.version = TABLEBASE_VERSION;
+	header.num_positions = NUM_POSITION_RANKS;
+	header.block_size = TABLEBASE_BLOCK_SIZE;
+	header.num_blocks = (NUM_POSITION_RANKS + TABLEBASE_BLOCK_SIZE - 1) / TABLEBASE_BLOCK_SIZE;
+	
+	// the offsets are filled in as the blocks are written, then the table
+	// is written again at the end
+	uint64_t *offsets = calloc(header.num_blocks + 1, sizeof(uint64_t));
+	uint8_t entries[TABLEBASE_BLOCK_SIZE];
+	uint8_t compressed[2 * TABLEBASE_BLOCK_SIZE];
+	if (!offsets) {
+		fclose(file);
+		return 1;
+	}
+	fwrite(&header, sizeof(header), 1, file);
+	fwrite(offsets, sizeof(uint64_t), header.num_blocks + 1, file);
+	uint64_t offset = sizeof(header) + (header.num_blocks + 1) * sizeof(uint64_t);
+	
+	uint8_t previous = TABLEBASE_ENTRY(RESULT_DRAW, 0);
+	for (uint32_t block = 0; block < header.num_blocks; block++) {
+		uint32_t first = block * TABLEBASE_BLOCK_SIZE;
+		uint32_t count = NUM_POSITION_RANKS - first;
+		if (count > TABLEBASE_BLOCK_SIZE) {
+			count = TABLEBASE_BLOCK_SIZE;
+		}
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t rank = first + i;
+			uint32_t pieces_1, pieces_2;
+			uint8_t player;
+			unrank_masks(rank, &pieces_1, &pieces_2, &player);
+			if (canonicalise_masks(&pieces_1, &pieces_2) == IDENTITY_TRANSFORM
+					|| rank_masks(pieces_1, pieces_2, player) == rank) {
+				previous = solution_entry(rank);
+				if (TABLEBASE_RESULT(previous) != RESULT_DRAW
+						&& distances[rank] > TABLEBASE_MAX_DISTANCE) {
+					fprintf(stderr, "distance %u too long to store\n", distances[rank]);
+					fclose(file);
+					return 1;
+				}
+			}
+			entries[i] = previous;
+		}
+		uint32_t size = tablebase_compress_block(entries, count, compressed);
+		fwrite(compressed, 1, size, file);
+		offsets[block] = offset;
+		offset += size;
+	}
+	offsets[header.num_blocks] = offset;
+	fseek(file, sizeof(header), SEEK_SET);
+	fwrite(offsets, sizeof(uint64_t), header.num_blocks + 1, file);
+	free(offsets);
+	if (ferror(file)) {
+		perror(filename);
+		fclose(file);
+		return 1;
+	}
+	printf("wrote %s: %u blocks, %llu bytes\n", filename, header.num_blocks,
+			(unsigned long long)offset);
+	return fclose(file) != 0;
+}
+
+// probes random positions, in a random symmetry, and compares them with
+// the solution
+static int check_tablebase(const char *filename) {
+	static uint32_t ranks[CHECK_BATCH];
+	static uint32_t pieces[2][CHECK_BATCH];
+	static uint8_t players[CHECK_BATCH];
+	static uint8_t entries[CHECK_BATCH];
+	Tablebase *tablebase = tablebase_open(filename);
+	uint32_t random_state = RANDOM_SEED;
+	double seconds = 0;
+	if (!tablebase) {
+		return 1;
+	}
+	for (uint32_t checked = 0; checked < NUM_CHECKS; checked += CHECK_BATCH) {
+		uint32_t count = NUM_CHECKS - checked < CHECK_BATCH ? NUM_CHECKS - checked : CHECK_BATCH;
+		for (uint32_t i = 0; i < count; i++) {
+			ranks[i] = ((uint64_t)random_number(&random_state) * NUM_POSITION_RANKS) >> 32;
+			unrank_masks(ranks[i], &pieces[0][i], &pieces[1][i], &players[i]);
+			uint8_t transform = (checked + i) % NUM_TRANSFORMS;
+			pieces[0][i] = transform_mask(transform, pieces[0][i]);
+			pieces[1][i] = transform_mask(transform, pieces[1][i]);
+		}
+		double start = now_seconds();
+		for (uint32_t i = 0; i < count; i++) {
+			uint8_t result, distance;
+			tablebase_probe_masks(tablebase, pieces[0][i], pieces[1][i], players[i],
+					&result, &distance);
+			entries[i] = TABLEBASE_ENTRY(result, distance);
+		}
+		seconds += now_seconds() - start;
+		for (uint32_t i = 0; i < count; i++) {
+			if (entries[i] != solution_entry(ranks[i])) {
+				fprintf(stderr, "rank %u does not match the solution\n", ranks[i]);
+				tablebase_close(tablebase);
+				return 1;
+			}
+		}
+	}
+	printf("checked %lu random probes, %.2f million probes per second\n",
+			NUM_CHECKS, NUM_CHECKS / seconds / 1e6);
+	tablebase_close(tablebase);
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	const char *input = "teeko.sol";
+	const char *output = "teeko.tb";
+	int option;
+	while ((option = getopt(argc, argv, "i:o:")) != -1) {
+		if (option == 'i') {
+			input = optarg;
+		} else if (option == 'o') {
+			output = optarg;
+		} else {
+			fprintf(stderr, "usage: %s [-i solution] [-o tablebase]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (read_solution(input) || write_tablebase(output) || check_tablebase(output)) {
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,474 @@
+/*
+ * tune.c
+ *
+ * Fits the evaluation weights (see eval.h) to the results of games the
+ * computer plays against itself, and writes them out as a new
+ * eval_weights.h.
+ *
+ * Games start with a few random moves, then both sides play the alpha-
+ * beta search with a fixed node budget. The games are shared out between
+ * threads, each game with its own random numbers, and their positions
+ * are gathered in game order, so the fit doesn't depend on the number
+ * of threads. Every position of every game is
+ * labelled with the game's result for player 1, or with its solved
+ * result if a tablebase is given. The evaluation is linear in its
+ * weights, so each position is reduced to a vector of feature counts and
+ * the weights are fitted by logistic regression on the labels (Texel's
+ * tuning method): the scale K of the sigmoid is first fitted to the
+ * current weights, then the weights are fitted by gradient descent with
+ * the gradient summed over the positions in parallel. The line weights
+ * are kept in order after every step, so a line with more of a player's
+ * pieces is never worth less to them.
+ *
+ * Author: Eve
+ *
+ * Usage: tune [-g games] [-n nodes] [-s tablebase] [-t threads] [-o header]
+ *
+ * Built for the host with make tools, as build/tune
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "ai.h"
+#include "eval.h"
+#include "movegen.h"
+#include "symmetry.h"
+#include "solution.h"
+#include "tablebase.h"
+#include "hostutil.h"
+#include "progmem.h"
+#include "eval_weights.h"
+
+#define MAX_THREADS 256
+
+#define DEFAULT_GAMES 2000
+#define DEFAULT_NODES 2000
+
+// games longer than this are called draws
+#define MAX_GAME_PLIES 200
+// each game starts with between 1 and this many random moves
+#define MAX_RANDOM_PLIES 8
+
+// features: lines with 1, 2 and 3 of a player's pieces and none of the
+// opponent's, pieces on each of the 6 kinds of square (the squares the
+// board symmetries map onto each other share a weight) and phase 2
+// mobility. Each is counted for player 1 less player 2.
+#define NUM_LINE_FEATURES 3
+#define NUM_SQUARE_CLASSES 6
+#define MOBILITY_FEATURE (NUM_LINE_FEATURES + NUM_SQUARE_CLASSES)
+#define NUM_FEATURES (MOBILITY_FEATURE + 1)
+
+#define ITERATIONS 3000
+#define LEARNING_RATE 0.05
+
+typedef struct {
+	float features[NUM_FEATURES];
+	// 1 for a player 1 win, 0.5 for a draw, 0 for a player 2 win
+	float label;
+} Sample;
+
+static Sample *samples;
+static size_t num_samples;
+
+// each game's samples, in its own slot of MAX_GAME_PLIES, before they
+// are gathered into samples
+static Sample *game_samples;
+static uint16_t *game_sample_counts;
+
+static uint32_t num_games = DEFAULT_GAMES;
+static uint32_t next_game;
+static uint32_t node_budget = DEFAULT_NODES;
+// the tablebase file, which each thread opens for itself
+static const char *solved;
+static int num_threads;
+
+// the smallest square of each class, and the class of each square
+static const uint8_t class_squares[NUM_SQUARE_CLASSES] = {0, 1, 2, 6, 7, 12};
+static uint8_t square_classes[NUM_SQUARES];
+
+static void find_square_classes(void) {
+	for (uint8_t square = 0; square < NUM_SQUARES; square++) {
+		uint8_t smallest = square;
+		for (uint8_t transform = 0; transform < NUM_TRANSFORMS; transform++) {
+			uint8_t moved = transform_square(transform, square);
+			if (moved < smallest) {
+				smallest = moved;
+			}
+		}
+		for (uint8_t n = 0; n < NUM_SQUARE_CLASSES; n++) {
+			if (class_squares[n] == smallest) {
+				square_classes[square] = n;
+			}
+		}
+	}
+}
+
+static void set_sample(Sample *sample, const Position *position, float label) {
+	memset(sample, 0, sizeof(Sample));
+	for (uint8_t line = 0; line < NUM_LINES; line++) {
+		uint8_t count_1 = position->line_counts[0][line];
+		uint8_t count_2 = position->line_counts[1][line];
+		if (count_2 == 0 && count_1 > 0) {
+			sample->features[count_1 - 1] += 1;
+		} else if (count_1 == 0 && count_2 > 0) {
+			sample->features[count_2 - 1] -= 1;
+		}
+	}
+	for (uint8_t square = 0; square < NUM_SQUARES; square++) {
+		uint8_t piece = position_piece_at(position, square);
+		if (piece != EMPTY_SQUARE) {
+			sample->features[NUM_LINE_FEATURES + square_classes[square]]
+					+= piece == PLAYER_1 ? 1 : -1;
+		}
+	}
+	sample->features[MOBILITY_FEATURE] = (float)eval_mobility(position, PLAYER_1)
+			- (float)eval_mobility(position, PLAYER_2);
+	sample->label = label;
+}
+
+static float solved_label(Tablebase *tablebase, const Position *position) {
+	uint8_t result, distance;
+	if (tablebase_probe(tablebase, position, &result, &distance)) {
+		fprintf(stderr, "could not look up a position\n");
+		exit(1);
+	}
+	if (result == RESULT_DRAW) {
+		return 0.5f;
+	}
+	return (result == RESULT_WIN) == (position->player == PLAYER_1) ? 1.0f : 0.0f;
+}
+
+// plays game number game and puts its positions in its slot of
+// game_samples, labelled from the tablebase if there is one
+static void play_game(uint32_t game, Tablebase *tablebase) {
+	Position position;
+	Position history[MAX_GAME_PLIES];
+	MoveList list;
+	uint32_t random_state = random_stream(RANDOM_SEED, game);
+	uint8_t random_plies = 1 + random_number(&random_state) % MAX_RANDOM_PLIES;
+	uint16_t plies = 0;
+	float result = 0.5f;
+
+	position_clear(&position);
+	ai_new_game();
+	while (plies < MAX_GAME_PLIES) {
+		// the player to move has lost, player 1 if it is their turn
+		if (position_is_lost(&position)) {
+			result = position.player == PLAYER_2 ? 1.0f : 0.0f;
+			break;
+		}
+		generate_moves(&position, &list);
+		history[plies++] = position;
+		if (plies <= random_plies) {
+			make_move(&position, list.moves[random_number(&random_state) % list.count]);
+		} else {
+			ai_search_start(&position);
+			while (ai_search_step(256) && ai_search_nodes() < node_budget) {
+				;
+			}
+			make_move(&position, ai_best_move());
+		}
+	}
+	// the random opening moves say nothing about the result
+	Sample *sample = &game_samples[(size_t)game * MAX_GAME_PLIES];
+	game_sample_counts[game] = 0;
+	for (uint16_t i = random_plies; i < plies; i++) {
+		set_sample(sample++, &history[i], tablebase ? solved_label(tablebase, &history[i]) : result);
+		game_sample_counts[game]++;
+	}
+}
+
+static void *game_worker(void *arg) {
+	Tablebase *tablebase = NULL;
+	(void)arg;
+	if (solved && !(tablebase = tablebase_open(solved))) {
+		exit(1);
+	}
+	while (1) {
+		uint32_t game = __atomic_fetch_add(&next_game, 1, __ATOMIC_RELAXED);
+		if (game >= num_games) {
+			break;
+		}
+		play_game(game, tablebase);
+	}
+	if (tablebase) {
+		tablebase_close(tablebase);
+	}
+	return NULL;
+}
+
+// plays every game over the threads and gathers their samples
+static void play_games(void) {
+	pthread_t threads[MAX_THREADS];
+	game_samples = malloc((size_t)num_games * MAX_GAME_PLIES * sizeof(Sample));
+	game_sample_counts = malloc(num_games * sizeof(uint16_t));
+	if (!game_samples || !game_sample_counts) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+	for (int i = 0; i < num_threads; i++) {
+		pthread_create(&threads[i], NULL, game_worker, NULL);
+	}
+	for (int i = 0; i < num_threads; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	// packed down in place, in game order
+	samples = game_samples;
+	num_samples = 0;
+	for (uint32_t game = 0; game < num_games; game++) {
+		memmove(&samples[num_samples], &game_samples[(size_t)game * MAX_GAME_PLIES],
+				game_sample_counts[game] * sizeof(Sample));
+		num_samples += game_sample_counts[game];
+	}
+	free(game_sample_counts);
+}
+
+// current weights in feature order, and the scale of the sigmoid
+static double weights[NUM_FEATURES];
+static double scale;
+
+typedef struct {
+	size_t first;
+	size_t last;
+	double error;
+	double gradient[NUM_FEATURES];
+} WorkerState;
+
+static void *error_worker(void *arg) {
+	WorkerState *state = arg;
+	state->error = 0;
+	memset(state->gradient, 0, sizeof(state->gradient));
+	for (size_t i = state->first; i < state->last; i++) {
+		const Sample *sample = &samples[i];
+		double score = 0;
+		for (int f = 0; f < NUM_FEATURES; f++) {
+			score += weights[f] * sample->features[f];
+		}
+		double predicted = 1.0 / (1.0 + exp(-scale * score));
+		double difference = predicted - sample->label;
+		state->error += difference * difference;
+		double slope = 2 * difference * scale * predicted * (1 - predicted);
+		for (int f = 0; f < NUM_FEATURES; f++) {
+			state->gradient[f] += slope * sample->features[f];
+		}
+	}
+	return NULL;
+}
+
+// returns the mean squared error of the predictions over every sample,
+// and sets gradient to its gradient with respect to the weights
+static double mean_error(double gradient[NUM_FEATURES]) {
+	pthread_t threads[MAX_THREADS];
+	WorkerState states[MAX_THREADS];
+	double error = 0;
+	for (int t = 0; t < num_threads; t++) {
+		states[t].first = num_samples * t / num_threads;
+		states[t].last = num_samples * (t + 1) / num_threads;
+		pthread_create(&threads[t], NULL, error_worker, &states[t]);
+	}
+	memset(gradient, 0, NUM_FEATURES * sizeof(double));
+	for (int t = 0; t < num_threads; t++) {
+		pthread_join(threads[t], NULL);
+		error += states[t].error;
+		for (int f = 0; f < NUM_FEATURES; f++) {
+			gradient[f] += states[t].gradient[f];
+		}
+	}
+	for (int f = 0; f < NUM_FEATURES; f++) {
+		gradient[f] /= num_samples;
+	}
+	return error / num_samples;
+}
+
+static void read_weights(void) {
+	for (int n = 0; n < NUM_LINE_FEATURES; n++) {
+		weights[n] = (int16_t)pgm_read_word(&eval_line_weights[n + 1]);
+	}
+	for (int n = 0; n < NUM_SQUARE_CLASSES; n++) {
+		weights[NUM_LINE_FEATURES + n] = (int16_t)pgm_read_word(&eval_square_weights[class_squares[n]]);
+	}
+	weights[MOBILITY_FEATURE] = EVAL_MOBILITY_WEIGHT;
+}
+
+// fits the scale of the sigmoid to the current weights by golden section
+// search, so the fitted weights stay in the same units
+static void fit_scale(void) {
+	double gradient[NUM_FEATURES];
+	double low = 0.001, high = 1.0;
+	const double ratio = 0.618033988749895;
+	for (int i = 0; i < 60; i++) {
+		double a = high - ratio * (high - low);
+		double b = low + ratio * (high - low);
+		scale = a;
+		double error_a = mean_error(gradient);
+		scale = b;
+		double error_b = mean_error(gradient);
+		if (error_a < error_b) {
+			high = b;
+		} else {
+			low = a;
+		}
+	}
+	scale = (low + high) / 2;
+}
+
+// puts the line weights back in order after a step, by pool adjacent
+// violators: neighbours out of order are replaced by their mean until
+// none are, and then none may be below the 0 of an empty line
+static void order_line_weights(void) {
+	double values[NUM_LINE_FEATURES];
+	uint8_t sizes[NUM_LINE_FEATURES];
+	int blocks = 0;
+	for (int n = 0; n < NUM_LINE_FEATURES; n++) {
+		values[blocks] = weights[n];
+		sizes[blocks] = 1;
+		blocks++;
+		while (blocks > 1 && values[blocks - 2] > values[blocks - 1]) {
+			values[blocks - 2] = (values[blocks - 2] * sizes[blocks - 2]
+					+ values[blocks - 1] * sizes[blocks - 1])
+					/ (sizes[blocks - 2] + sizes[blocks - 1]);
+			sizes[blocks - 2] += sizes[blocks - 1];
+			blocks--;
+		}
+	}
+	int n = 0;
+	for (int block = 0; block < blocks; block++) {
+		for (uint8_t i = 0; i < sizes[block]; i++) {
+			weights[n++] = values[block] > 0 ? values[block] : 0;
+		}
+	}
+}
+
+// gradient descent with Adam step sizes
+static void fit_weights(void) {
+	double gradient[NUM_FEATURES];
+	double moment[NUM_FEATURES] = {0};
+	double velocity[NUM_FEATURES] = {0};
+	const double beta_1 = 0.9, beta_2 = 0.999;
+	for (int i = 1; i <= ITERATIONS; i++) {
+		double error = mean_error(gradient);
+		if (i == 1 || i % 500 == 0) {
+			printf("iteration %d: error %.6f\n", i, error);
+		}
+		for (int f = 0; f < NUM_FEATURES; f++) {
+			moment[f] = beta_1 * moment[f] + (1 - beta_1) * gradient[f];
+			velocity[f] = beta_2 * velocity[f] + (1 - beta_2) * gradient[f] * gradient[f];
+			double step = LEARNING_RATE * (moment[f] / (1 - pow(beta_1, i)))
+					/ (sqrt(velocity[f] / (1 - pow(beta_2, i))) + 1e-12);
+			weights[f] -= step;
+		}
+		order_line_weights();
+	}
+}
+
+static int16_t rounded_weight(int f) {
+	// keep well inside the range the search uses for ordinary scores
+	double weight = round(weights[f]);
+	if (weight > 300) {
+		weight = 300;
+	} else if (weight < -300) {
+		weight = -300;
+	}
+	return (int16_t)weight;
+}
+
+static int write_weights(const char *filename, double error) {
+	FILE *file = fopen(filename, "w");
+	if (!file) {
+		perror(filename);
+		return 1;
+	}
+	fprintf(file, "/*\n"
+			" * eval_weights.h\n"
+			" *\n"
+			" * Weights for the static evaluation (see eval.h), generated by\n"
+			" * tools/tune from %lu positions of %lu games, labelled with\n"
+			" * %s. Mean squared error %.5f with sigmoid\n"
+			" * scale %.5f.\n"
+			" */\n\n"
+			"#ifndef EVAL_WEIGHTS_H_\n"
+			"#define EVAL_WEIGHTS_H_\n\n"
+			"// value of a line holding this many of a player's pieces and none of the\n"
+			"// opponent's\n"
+			"static const int16_t eval_line_weights[4] PROGMEM = {0, %d, %d, %d};\n\n"
+			"// value of a piece on each square, the centre squares being on more lines\n"
+			"static const int16_t eval_square_weights[NUM_SQUARES] PROGMEM = {\n",
+			(unsigned long)num_samples, (unsigned long)num_games,
+			solved ? "their solved results" : "the game results",
+			error, scale, rounded_weight(0), rounded_weight(1), rounded_weight(2));
+	for (uint8_t square = 0; square < NUM_SQUARES; square++) {
+		fprintf(file, "%s%d,%s", square % WIDTH ? " " : "\t",
+				rounded_weight(NUM_LINE_FEATURES + square_classes[square]),
+				square % WIDTH == WIDTH - 1 ? "\n" : "");
+	}
+	fprintf(file, "};\n\n"
+			"// value of each move a player could make in phase 2\n"
+			"#define EVAL_MOBILITY_WEIGHT %d\n\n"
+			"#endif /* EVAL_WEIGHTS_H_ */\n", rounded_weight(MOBILITY_FEATURE));
+	if (fclose(file)) {
+		perror(filename);
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	const char *output = "eval_weights.h";
+	Tablebase *tablebase;
+	double gradient[NUM_FEATURES];
+	int option;
+
+	num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	while ((option = getopt(argc, argv, "g:n:s:t:o:")) != -1) {
+		if (option == 'g') {
+			num_games = atoi(optarg);
+		} else if (option == 'n') {
+			node_budget = atoi(optarg);
+		} else if (option == 's') {
+			solved = optarg;
+		} else if (option == 't') {
+			num_threads = atoi(optarg);
+		} else if (option == 'o') {
+			output = optarg;
+		} else {
+			fprintf(stderr, "usage: %s [-g games] [-n nodes] [-s tablebase] [-t threads] [-o header]\n",
+					argv[0]);
+			return 1;
+		}
+	}
+	if (num_threads < 1) {
+		num_threads = 1;
+	} else if (num_threads > MAX_THREADS) {
+		num_threads = MAX_THREADS;
+	}
+	if (num_games < 1) {
+		num_games = 1;
+	}
+	// opened here only to stop early if it's no good
+	if (solved) {
+		if (!(tablebase = tablebase_open(solved))) {
+			return 1;
+		}
+		tablebase_close(tablebase);
+	}
+	find_square_classes();
+
+	double start = now_seconds();
+	play_games();
+	printf("%lu positions from %u games on %d threads (%.1fs)\n", (unsigned long)num_samples,
+			num_games, num_threads, now_seconds() - start);
+
+	read_weights();
+	fit_scale();
+	printf("sigmoid scale %.5f, error %.6f with the current weights\n",
+			scale, mean_error(gradient));
+	fit_weights();
+	double error = mean_error(gradient);
+	printf("error %.6f with the fitted weights\n", error);
+	return write_weights(output, error);
+}
@@ -0,0 +1,71 @@
+/*
+ * zobrist.c
+ *
+ * Random keys used to hash Teeko positions
+ *
+ * Author: Eve
+ */
+
+#include "zobrist.h"
+#include "progmem.h"
+
+// The keys are written out at 64 bits and cut down to the size of a
+// ZobristKey, so the device uses the low 32 bits of the host keys.
+#define ZOBRIST_KEY(k) ((ZobristKey)(k))
+
+#ifdef __AVR__
+#define read_key(address) pgm_read_dword(address)
+#else
+#define read_key(address) (*(address))
+#endif
+
+static const ZobristKey piece_keys[2][NUM_SQUARES] PROGMEM = {
+	{
+		ZOBRIST_KEY(0x925FDAF0BC8F49AFULL), ZOBRIST_KEY(0xCF0686760831E036ULL), ZOBRIST_KEY(0x45B5FB634522642AULL),
+		ZOBRIST_KEY(0x827073B616E3BDE6ULL), ZOBRIST_KEY(0x2DAA14BCECA77B54ULL), ZOBRIST_KEY(0x3CED842EB104B326ULL),
+		ZOBRIST_KEY(0x55C6A02B608A7437ULL), ZOBRIST_KEY(0xF9B9130CAEFF245DULL), ZOBRIST_KEY(0xA0B8A4939B579EA4ULL),
+		ZOBRIST_KEY(0xBB8489B78D489BDAULL), ZOBRIST_KEY(0xB53E67836C447A7EULL), ZOBRIST_KEY(0xF4125EDA6A9205DAULL),
+		ZOBRIST_KEY(0x9A379B95DBEAC5CBULL), ZOBRIST_KEY(0xD72C3586D259C3DCULL), ZOBRIST_KEY(0xAAC0369D95A147CFULL),
+		ZOBRIST_KEY(0xB504DE4BB4E3164BULL), ZOBRIST_KEY(0x3E0B5EAF728DCDAEULL), ZOBRIST_KEY(0xD11DC89735DD330CULL),
+		ZOBRIST_KEY(0x8B342A42ED163DB2ULL), ZOBRIST_KEY(0x14B471F5CC155415ULL), ZOBRIST_KEY(0xCC3AB575228D8647ULL),
+		ZOBRIST_KEY(0xCBC45FFD9E33BF1FULL), ZOBRIST_KEY(0xAC4BCE63110F34E2ULL), ZOBRIST_KEY(0x1F1FC16E376DE2C2ULL),
+		ZOBRIST_KEY(0xA4BA5E6DBF5B98DAULL),
+	},
+	{
+		ZOBRIST_KEY(0x17D31691EB376728ULL), ZOBRIST_KEY(0x897F3A7AD1F7D12CULL), ZOBRIST_KEY(0xFF2B01CEEDA71D5FULL),
+		ZOBRIST_KEY(0x3395CDB69BC4AF4AULL), ZOBRIST_KEY(0x612F357D4874BC06ULL), ZOBRIST_KEY(0x10D3A3AD963EB9BBULL),
+		ZOBRIST_KEY(0x598DDCFA4EA23435ULL), ZOBRIST_KEY(0x6D86C2BD78C4BA36ULL), ZOBRIST_KEY(0x5578D7D01B0F5B8FULL),
+		ZOBRIST_KEY(0xEDC6F18177C05F02ULL), ZOBRIST_KEY(0xF7C73E565EED9AF1ULL), ZOBRIST_KEY(0x4BEED9A846A13656ULL),
+		ZOBRIST_KEY(0x14543DDD6429CEF2ULL), ZOBRIST_KEY(0x6D9EA4F7D2498962ULL), ZOBRIST_KEY(0x4F413C6A42908514ULL),
+		ZOBRIST_KEY(0x50BCAF533BC74781ULL), ZOBRIST_KEY(0xBA8E5D13DB524ED0ULL), ZOBRIST_KEY(0xF58A5232A65939B3ULL),
+		ZOBRIST_KEY(0xE156018CB3E734C3ULL), ZOBRIST_KEY(0x78F0D6A28CF38A93ULL), ZOBRIST_KEY(0x2BDE763641F67458ULL),
+		ZOBRIST_KEY(0x3B8AAB9B48DC145DULL), ZOBRIST_KEY(0x1D89FE2A16FBD429ULL), ZOBRIST_KEY(0xF0C76C4DAACF0E7BULL),
+		ZOBRIST_KEY(0xDB88FAA5E983D390ULL),
+	},
+};
+
+static const ZobristKey lifted_keys[NUM_SQUARES] PROGMEM = {
+	ZOBRIST_KEY(0x009B54DC277AE3D3ULL), ZOBRIST_KEY(0x3B7A05E8F48858F0ULL), ZOBRIST_KEY(0xDD5015734EC158AFULL),
+	ZOBRIST_KEY(0x84988C3D561749A2ULL), ZOBRIST_KEY(0x21A8CE7CA70A00D4ULL), ZOBRIST_KEY(0x8AD129604DA4AB22ULL),
+	ZOBRIST_KEY(0x9A39F9DC4FCE1F03ULL), ZOBRIST_KEY(0xC9320BFA828B17C4ULL), ZOBRIST_KEY(0xC67A3F7346A28E91ULL),
+	ZOBRIST_KEY(0x43C4AA1ADFA89363ULL), ZOBRIST_KEY(0xBCFA7B6CA6123003ULL), ZOBRIST_KEY(0xC0367552C7D81147ULL),
+	ZOBRIST_KEY(0xB567F9A1ADDCC9DFULL), ZOBRIST_KEY(0x8629839F750479C1ULL), ZOBRIST_KEY(0x81291103CDFBC7FCULL),
+	ZOBRIST_KEY(0xC1BB8A9B712D34BEULL), ZOBRIST_KEY(0xA41AD397EAC2B934ULL), ZOBRIST_KEY(0x17F3E97392F805E9ULL),
+	ZOBRIST_KEY(0x7CE80B4268DEC68DULL), ZOBRIST_KEY(0xE7427A37C0FC8E17ULL), ZOBRIST_KEY(0xB8E962C8EB856EF8ULL),
+	ZOBRIST_KEY(0x2CF0A708B142FF62ULL), ZOBRIST_KEY(0x73E376D77408A800ULL), ZOBRIST_KEY(0xFFAF46DE2699AB7EULL),
+	ZOBRIST_KEY(0x9FE6967E228B5FB4ULL),
+};
+
+static const ZobristKey player_2_key PROGMEM = ZOBRIST_KEY(0x311F28FC1C3CBFA6ULL);
+
+ZobristKey zobrist_piece_key(uint8_t player, uint8_t square) {
+	return read_key(&piece_keys[player - 1][square]);
+}
+
+ZobristKey zobrist_lifted_key(uint8_t square) {
+	return read_key(&lifted_keys[square]);
+}
+
+ZobristKey zobrist_player_key(void) {
+	return read_key(&player_2_key);
+}
@@ -0,0 +1,36 @@
+/*
+ * zobrist.h
+ *
+ * Author: Eve
+ *
+ * Zobrist hashing of Teeko positions. A position's key is the XOR of a
+ * random key for each piece on the board, a key for the square a piece
+ * has been lifted from (if any) and a key when it is player 2's turn.
+ * Keys are 32 bits on the AVR, to save flash and SRAM, and 64 bits when
+ * built for the host.
+ */
+
+
+#ifndef ZOBRIST_H_
+#define ZOBRIST_H_
+
+#include <stdint.h>
+#include "lines.h"
+
+#ifdef __AVR__
+typedef uint32_t ZobristKey;
+#else
+typedef uint64_t ZobristKey;
+#endif
+
+// key for a piece belonging to player on square
+ZobristKey zobrist_piece_key(uint8_t player, uint8_t square);
+
+// key for a piece having been lifted from square part way through a move
+ZobristKey zobrist_lifted_key(uint8_t square);
+
+// key included when it is player 2's turn
+ZobristKey zobrist_player_key(void);
+
+
+#endif /* ZOBRIST_H_ */